@@ -118,6 +118,22 @@ int main(int argc, char *argv[])
     return 0;
 }}
 """
+templateSharedLibrary = """
+#include <tiramisu/tiramisu.h>
+#include <TiraLibCPP/function_loader.h>
+
+using namespace tiramisu;
+
+extern "C" void build_{name}(function_continuation continuation)
+{{
+    std::string function_name = "{name}";
+
+    {body}
+
+    continuation({buffers});
+}}
+"""
+
 cmakeHeaderTemplate = """
 set(INCLUDES
 ${HalideInclude}
@@ -138,8 +154,17 @@ target_link_libraries({function} TiraLibCPP tiramisu tiramisu_auto_scheduler Hal
 
 """
 
+cmakeSharedLibraryTemplate = """
+
+add_library({function} SHARED {function}.cpp)
+target_link_directories({function} PUBLIC ${{TIRAMISU_ROOT}}/build ${{HalideLib}} ${{TIRAMISU_ROOT}}/3rdParty/isl/build/lib {libTiraLibCPPPath})
+target_include_directories({function} PUBLIC ${{INCLUDES}})
+target_link_libraries({function} TiraLibCPP tiramisu tiramisu_auto_scheduler Halide isl ZLIB::ZLIB)
 
-def generate_function_from_cpp_file(original_str: str, abstracted: bool = False, use_sqlite3: bool = False):
+"""
+
+
+def generate_function_from_cpp_file(original_str: str, abstracted: bool = False, use_sqlite3: bool = False, shared_library: bool = False):
     """
     Generate a function from a cpp file
 
@@ -164,7 +189,13 @@ def generate_function_from_cpp_file(original_str: str, abstracted: bool = False,
     ]
 
     # fill the template
-    if abstracted:
+    if shared_library:
+        function_str = templateSharedLibrary.format(
+            name=name,
+            body=body,
+            buffers=buffers_vector,
+        )
+    elif abstracted:
         function_str = templateWithEverythinginTiraLibCPP.format(
             name=name,
             body=body,
@@ -182,20 +213,26 @@ def generate_functions(
     libTiraLibCPPPath: str,
     dest_path: str = "./src/functions",
     use_sqlite3: bool = False,
+    shared_library: bool = False,
 ):
     cmakeContent = cmakeHeaderTemplate
 
     # for name, body in tqdm(function_names):
     for name, body in function_names:
-        function_content = generate_function_from_cpp_file(body, True, use_sqlite3=use_sqlite3)
+        function_content = generate_function_from_cpp_file(body, True, use_sqlite3=use_sqlite3, shared_library=shared_library)
         function_path = Path(dest_path) / f"{name}.cpp"
 
         with open(function_path, "w") as f:
             f.write(function_content)
 
-        cmakeContent += cmakeFunctionTemplate.format(
-            function=name, libTiraLibCPPPath=libTiraLibCPPPath, sqlite3="sqlite3" if use_sqlite3 else ""
-        )
+        if shared_library:
+            cmakeContent += cmakeSharedLibraryTemplate.format(
+                function=name, libTiraLibCPPPath=libTiraLibCPPPath
+            )
+        else:
+            cmakeContent += cmakeFunctionTemplate.format(
+                function=name, libTiraLibCPPPath=libTiraLibCPPPath, sqlite3="sqlite3" if use_sqlite3 else ""
+            )
 
     cmakeContent += "\n"
 
@@ -256,6 +293,13 @@ def get_args():
         type=bool,
     )
 
+    # generate shared libraries exporting build_<function_name> for the in-process Python bindings
+    parser.add_argument(
+        "--shared-library",
+        help="Generate shared libraries instead of executables",
+        action="store_true",
+    )
+
     args = parser.parse_args()
     return args
 
@@ -440,7 +484,9 @@ if __name__ == "__main__":
         logging.info(f"Generating functions from {i} to {i + args.batch_size}")
         clean_functions()
         generate_functions(
-            functions_tuples[i : i + args.batch_size], args.libTiraLibCPP_path
+            functions_tuples[i : i + args.batch_size],
+            args.libTiraLibCPP_path,
+            shared_library=args.shared_library,
         )
         logging.info("Compiling functions")
         start_time = time.time()
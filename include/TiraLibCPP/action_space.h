@@ -0,0 +1,42 @@
+#pragma once
+
+#include <tiramisu/tiramisu.h>
+#include <TiraLibCPP/utils.h>
+#include <TiraLibCPP/function_loader.h>
+
+#include <vector>
+
+// Actions and factors proposed for every loop nest of the function
+struct ActionMenu
+{
+    bool parallelization = true;
+    std::vector<int> unrolling_factors = {4, 8};
+    std::vector<int> vectorization_widths = {};
+    std::vector<int> tiling_factors = {32, 64};
+    bool interchange = true;
+    bool reversal = false;
+    bool skewing = true;
+    bool fusion = true;
+};
+
+// Computations grouped by the outermost loop they share, in execution order.
+// Expects the schedules to be prepared with tiramisu::prepare_schedules_for_legality_checks.
+std::vector<std::vector<tiramisu::computation *>> get_loop_nests(tiramisu::function *implicit_function);
+
+// Number of loop levels shared by all the computations of a loop nest
+int get_shared_depth(std::vector<tiramisu::computation *> &loop_nest);
+
+// Actions that can follow the current schedules of the implicit function, their legality is not checked
+std::vector<std::string> get_candidate_actions(tiramisu::function *implicit_function, const ActionMenu &menu);
+
+struct ActionMask
+{
+    std::vector<std::string> actions;
+    std::vector<bool> legal;
+};
+
+// Candidate actions after the schedule prefix and whether prefix|action is legal, in one call.
+// The prefix is applied once and the schedules are restored between candidates, the P, U and V candidates are
+// checked without applying their tags. Only the actions that change the order of the computations (fusion,
+// distribution, multi-computation tiling...) rebuild the function.
+ActionMask get_legal_actions_mask(std::string function_name, function_builder builder, std::string prefix, const ActionMenu &menu);
@@ -3,10 +3,25 @@
 #include <tiramisu/tiramisu.h>
 #include <TiraLibCPP/utils.h>
 
+// Applies one action to the implicit function and returns whether it is legal. An illegal action may leave the
+// function partly transformed (e.g. a failed fusion keeps the computations fused before the one that failed), so
+// the function has to be rebuilt before another schedule is applied to it.
 bool apply_action(std::string action_str, tiramisu::function *implicit_function, Result &result);
 
 bool apply_actions_from_schedule_str(std::string schedule_str, tiramisu::function *implicit_function, Result &result);
 
-Result schedule_str_to_result(std::string function_name, std::string schedule_str, Operation operation, std::vector<tiramisu::buffer *> buffers);
+// Legality of the whole scheduled function. The dependences between a producer moved by compute_at and its consumer
+// were checked by the action itself and are left out, the dependences of other computations into the producer are
+// checked against the consumer iterations that read it. The dependences of the function are not modified.
+bool check_legality_of_scheduled_function(tiramisu::function *implicit_function);
+
+// With Operation::prediction and a prediction_input, the input of the cost model is stored there instead of being
+// sent to the model (it stays empty when the schedule is illegal or not supported by the model), see predict_speedups.
+Result schedule_str_to_result(std::string function_name, std::string schedule_str, Operation operation, std::vector<tiramisu::buffer *> buffers, std::string *prediction_input = nullptr);
+
+// Speedups predicted by the cost model for the inputs, sent to the model process in chunks of 64 instead of one by one
+std::vector<double> predict_speedups(std::vector<std::string> prediction_inputs);
+
+std::string get_program_annotations(tiramisu::function *implicit_function);
 
 void schedule_str_to_result_str(std::string function_name, std::string schedule_str, Operation operation, std::vector<tiramisu::buffer *> buffers);
\ No newline at end of file
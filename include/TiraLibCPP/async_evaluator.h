@@ -0,0 +1,53 @@
+#pragma once
+
+#include <TiraLibCPP/utils.h>
+
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <mutex>
+
+struct AsyncRequest
+{
+    uint64_t id;
+    std::future<Result> future;
+};
+
+struct AsyncRequestState;
+
+// Evaluates schedules asynchronously, each request runs the generated executable of the function in its own process.
+// Requests run in one of max_in_flight working directories (<work_dir>/slot_<k>) so that concurrent executions
+// never overwrite each other's object files and wrappers.
+class AsyncEvaluator
+{
+public:
+    AsyncEvaluator(std::string executable_path, size_t max_in_flight, std::string work_dir = "");
+    ~AsyncEvaluator();
+
+    // Blocks while max_in_flight requests are running
+    AsyncRequest submit(std::string schedule_str, Operation operation);
+
+    // Returns false instead of blocking when max_in_flight requests are running
+    bool try_submit(std::string schedule_str, Operation operation, AsyncRequest &request);
+
+    // Kills the process of a request, its future then holds an unsuccessful Result. Returns false if the request already finished.
+    bool cancel(uint64_t request_id);
+
+    void cancel_all();
+
+    size_t in_flight();
+
+private:
+    AsyncRequest start_request(std::string schedule_str, Operation operation);
+    void wait_for_request(std::shared_ptr<AsyncRequestState> state, int output_fd);
+
+    std::string executable_path;
+    std::string function_name;
+    size_t max_in_flight;
+    std::vector<std::string> slot_dirs;
+    std::vector<bool> slot_used;
+    uint64_t next_request_id = 0;
+    std::map<uint64_t, std::shared_ptr<AsyncRequestState>> requests;
+    std::mutex mutex;
+    std::condition_variable slot_released;
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct ParsedAction
+{
+    std::string name;
+    std::vector<std::string> args;
+    std::vector<std::string> comps;
+};
+
+ParsedAction parse_action_str(std::string action_str);
+
+std::string action_to_str(ParsedAction &action);
+
+std::string canonicalize_action_str(std::string action_str);
+
+// Normalizes formatting, sorts order-insensitive computation lists and drops no-op or cancelling actions
+std::string canonicalize_schedule_str(std::string schedule_str);
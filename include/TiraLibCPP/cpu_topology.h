@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct CPUInfo
+{
+    int id;
+    int core;
+    int package;
+    int node;
+    // 0 for the first hardware thread of its core, 1 for its SMT sibling...
+    int thread;
+};
+
+// Parses a sysfs CPU list such as "0-3,8,10-11"
+std::vector<int> parse_cpu_list(std::string cpu_list);
+
+// Online CPUs described by the sysfs tree at sysfs_root, ordered by id
+std::vector<CPUInfo> get_cpu_topology(std::string sysfs_root = "/sys/devices/system");
+
+// CPUs of the machine that the process is allowed to run on
+std::vector<CPUInfo> get_allowed_cpus();
+
+// CPUs for nb_threads threads with the affinity policy:
+// "compact" fills the SMT siblings of a core before the next core and a NUMA node before the next one,
+// "scatter" spreads the threads over the NUMA nodes and over the cores before using SMT siblings,
+// "numa" keeps the threads on the first NUMA node, one per core before using SMT siblings.
+// Returns no CPU when the policy cannot place that many threads on distinct CPUs.
+std::vector<int> get_affinity_cpus(const std::vector<CPUInfo> &cpus, int nb_threads, std::string policy);
+
+// Splits the CPUs into nb_slots disjoint sets of whole cores (SMT siblings stay together). Every NUMA node gets
+// a number of slots proportional to its cores and slots do not cross nodes, unless there are fewer slots than nodes
+// and a slot takes several whole nodes. Throws std::invalid_argument when there are more slots than cores.
+std::vector<std::vector<int>> partition_cpus(const std::vector<CPUInfo> &cpus, int nb_slots);
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <tiramisu/tiramisu.h>
+
+#include <string>
+
+// Hash of everything the dependence analysis depends on (domains, accesses, expressions, buffers and initial
+// schedules). The schedules must have been prepared by prepare_schedules_for_legality_checks so that they include
+// the ordering of the computations.
+std::string get_function_source_hash(tiramisu::function *implicit_function);
+
+bool save_dependency_snapshot(std::string snapshot_path, std::string function_hash, tiramisu::function *implicit_function);
+
+bool load_dependency_snapshot(std::string snapshot_path, std::string function_hash, tiramisu::function *implicit_function);
+
+// Reuses the dependence analysis of the same function from earlier in the process or from TIRAMISU_DEPS_CACHE_DIR
+// when possible, otherwise performs the full analysis (and saves it)
+void perform_dependency_analysis_with_snapshot(std::string function_name, tiramisu::function *implicit_function);
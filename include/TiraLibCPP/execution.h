@@ -0,0 +1,161 @@
+#pragma once
+
+#include <tiramisu/tiramisu.h>
+#include <TiraLibCPP/cpu_topology.h>
+#include <TiraLibCPP/utils.h>
+
+#include <sys/resource.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// How the schedules are executed, read from the TIRAMISU_* environment variables of the process
+struct ExecutionOptions
+{
+    // run the wrapper generated from the buffers of the function (TIRAMISU_BUILTIN_WRAPPER=1), it is also used when
+    // the function has no wrapper of its own
+    bool builtin_wrapper = false;
+    // number of timed runs of the builtin wrapper (TIRAMISU_NB_EXEC)
+    int nb_exec = 10;
+    // hardware counters around an untimed run (TIRAMISU_PERF_COUNTERS=1), needs the builtin wrapper
+    bool perf_counters = false;
+    // "warm" runs the kernel once before the timed runs, "cold" flushes the last-level cache before every timed run
+    // (TIRAMISU_CACHE_MODE), both need the builtin wrapper. Empty leaves the wrapper's default.
+    std::string cache_mode;
+    // allocation and initialization of the buffers by the builtin wrapper, see tiralib::AllocationOptions
+    // (TIRAMISU_HUGEPAGES, TIRAMISU_NUMA, TIRAMISU_FILL, TIRAMISU_FILL_SEED)
+    std::string hugepages = "none";
+    std::string numa = "default";
+    std::string fill = "random";
+    uint64_t fill_seed = 0;
+    // compare the outputs of the run with the ones of the unscheduled function (TIRAMISU_VALIDATE=1), needs the
+    // builtin wrapper. Negative tolerances keep the defaults of the wrapper runtime for the type of every output
+    // (TIRAMISU_VALIDATION_RTOL, TIRAMISU_VALIDATION_ATOL).
+    bool validate = false;
+    double validation_rtol = -1;
+    double validation_atol = -1;
+    // file the outputs of the run are written to instead of being compared (TIRAMISU_RECORD_REFERENCE)
+    std::string record_reference;
+    // reference outputs the run is compared with, set by execute_function
+    std::string validate_reference;
+    // operation counts, compulsory memory traffic and the rates achieved by the schedule (TIRAMISU_ROOFLINE=1)
+    bool roofline = false;
+    // problem sizes of functions whose buffer sizes are symbolic parameters, e.g. "N=64,M=32;N=128,M=64"
+    // (TIRAMISU_PROBLEM_SIZES). The schedule is compiled once and the builtin wrapper measures every size.
+    std::string problem_sizes;
+    // thread counts measured one after the other with the same compiled schedule (TIRAMISU_THREAD_COUNTS=1,2,4,8)
+    std::vector<int> thread_counts;
+    // affinity policies of the thread sweep (TIRAMISU_AFFINITY=compact,scatter,numa), see get_affinity_cpus
+    std::vector<std::string> affinity_policies = {"compact"};
+    // number of disjoint CPU sets the machine is split into so that several processes can measure at the same time
+    // (TIRAMISU_MEASUREMENT_SLOTS), 0 runs the wrappers on all the CPUs of the process
+    int measurement_slots = 0;
+    // lock files of the slots, shared by all the processes of the node (TIRAMISU_SLOT_LOCK_DIR)
+    std::string slot_lock_dir = "/tmp/tiralib_slots";
+    // delegated cgroup v2 directory in which a cpuset cgroup is created for every slot (TIRAMISU_SLOT_CGROUP),
+    // without it the slots only rely on the affinity of the wrappers
+    std::string slot_cgroup;
+};
+
+ExecutionOptions get_execution_options();
+
+// Whether some buffer sizes are symbolic parameters. Their values are given by the problem sizes of the execution
+// options and a p_int32 input buffer named SIZES gets the values of all the parameters, sorted by parameter name.
+bool is_parametric(std::vector<tiramisu::buffer *> buffers);
+
+// Source of a wrapper that allocates and fills the buffers of the function and times it with wrapper_runtime.h.
+// The buffers are the arguments of the function, in the order given to tiramisu::codegen.
+std::string generate_wrapper_source(std::string function_name, std::vector<tiramisu::buffer *> buffers);
+
+// Source of a wrapper that times several variants of the function with tiralib::measure_variants, the shared
+// libraries of the variants are its arguments
+std::string generate_variants_wrapper_source(std::string function_name, std::vector<tiramisu::buffer *> buffers);
+
+struct WrapperRun
+{
+    bool success;
+    std::string output;
+    // "<key> <value>" lines written by the wrapper runtime to TIRAMISU_REPORT_FILE
+    std::map<std::string, std::string> report;
+    // resources used by the wrapper process and its threads, from wait4
+    struct rusage usage;
+};
+
+// Copies the peak memory, page faults, context switches and CPU times of the wrapper run to the result
+void set_resource_usage(const WrapperRun &run, Result &result);
+
+// Threads and CPUs of a wrapper run, the default is the environment and the affinity of the process
+struct WrapperPlacement
+{
+    int nb_threads = 0;
+    std::vector<int> cpus;
+    // cgroup.procs file of the cgroup the wrapper moves itself to
+    std::string cgroup_procs;
+};
+
+// A slot of partition_cpus(get_allowed_cpus(), options.measurement_slots), held through a lock file until the slot
+// is destroyed. The constructor takes the first free slot and waits for one when they are all used.
+class MeasurementSlot
+{
+public:
+    MeasurementSlot(const ExecutionOptions &options);
+    ~MeasurementSlot();
+
+    MeasurementSlot(const MeasurementSlot &) = delete;
+    MeasurementSlot &operator=(const MeasurementSlot &) = delete;
+
+    int index = -1;
+    std::vector<CPUInfo> cpus;
+    // empty when the cpuset cgroup of the slot could not be set up
+    std::string cgroup_procs;
+
+    WrapperPlacement get_placement();
+
+private:
+    int lock_fd = -1;
+};
+
+std::map<std::string, std::string> read_report(std::string report_path);
+
+// Runs the wrapper executable with the variables of the options added to its environment
+WrapperRun run_wrapper(std::string wrapper_path, const ExecutionOptions &options, const WrapperPlacement &placement = WrapperPlacement(), const std::vector<std::string> &arguments = {});
+
+// Runs the wrapper with every thread count and affinity policy of the options and returns a JSON array of
+// {"threads", "affinity", "cpus", "exec_times", "median", "speedup", "efficiency"}. The speedup and the parallel
+// efficiency are relative to the smallest thread count of the same policy. The threads are placed on the given CPUs.
+std::string run_thread_sweep(std::string wrapper_path, const ExecutionOptions &options, const std::vector<CPUInfo> &cpus, Result &result);
+
+// Reference outputs of the unscheduled function for the fill of the inputs, in TIRAMISU_DEPS_CACHE_DIR or in the
+// working directory. function_hash is get_function_source_hash of the function before any action, so that a
+// function that changed under the same name is not compared with the outputs of the old one.
+std::string get_reference_path(std::string function_name, std::string function_hash, const ExecutionOptions &options);
+
+// Records the reference outputs of the function unless they already exist and returns whether they exist afterwards.
+// run_unscheduled has to execute the function without schedule, either by calling execute_function in the process
+// (which then records to the given file) or in a child process with TIRAMISU_RECORD_REFERENCE set to the file.
+bool ensure_reference_output(std::string function_name, std::string function_hash, std::function<void(std::string)> run_unscheduled);
+
+// Peak double precision GFLOP/s and memory bandwidth in GB/s of the machine, measured by the benchmark of
+// wrapper_runtime.h the first time and cached in TIRAMISU_DEPS_CACHE_DIR (or the working directory) per host name.
+// Both are 0 when the benchmark could not run.
+struct MachinePeaks
+{
+    double gflops = 0;
+    double bandwidth = 0;
+};
+
+MachinePeaks get_machine_peaks();
+
+// Generates the code of the scheduled implicit function, runs it with its wrapper and fills the execution fields of the result.
+// function_hash is the one of the function before any action, it keys the reference outputs.
+void execute_function(std::string function_name, std::string function_hash, std::vector<tiramisu::buffer *> buffers, Result &result);
+
+// Variants of a function are schedules of the same function compiled side by side and timed in one wrapper process.
+// generate_variant generates <variant_name>.o from the scheduled implicit function (and the variants wrapper the first
+// time), link_variants links the shared libraries of the variants with nb_jobs concurrent compilers (0 uses every
+// hardware thread) and execute_variants returns the execution times of every variant, empty when it failed.
+void generate_variant(std::string function_name, std::string variant_name, std::vector<tiramisu::buffer *> buffers);
+void link_variants(std::vector<std::string> variant_names, int nb_jobs);
+std::vector<std::vector<double>> execute_variants(std::string function_name, std::vector<std::string> variant_names, Result &result);
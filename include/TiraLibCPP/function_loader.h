@@ -0,0 +1,23 @@
+#pragma once
+
+#include <tiramisu/tiramisu.h>
+#include <TiraLibCPP/utils.h>
+
+#include <functional>
+
+// Called once the function is declared in the implicit function, the buffers stay alive until it returns
+typedef std::function<void(std::vector<tiramisu::buffer *>)> function_continuation;
+
+// Declares a function from scratch (it calls tiramisu::init) and passes its buffers to the continuation.
+// Shared libraries generated by generation_scripts/generate_code_no_grpc.py --shared-library export one as build_<function_name>.
+typedef void (*function_builder)(function_continuation continuation);
+
+function_builder load_function_builder(std::string library_path, std::string function_name);
+
+// Rebuilds the function and evaluates one schedule on it, so consecutive calls never see each other's actions
+Result builder_schedule_str_to_result(std::string function_name, function_builder builder, std::string schedule_str, Operation operation);
+
+// Rebuilds the function for each schedule and predicts the speedups of all of them together, see predict_speedups
+std::vector<Result> builder_schedule_strs_to_predictions(std::string function_name, function_builder builder, std::vector<std::string> schedule_strs);
+
+std::string builder_get_program_annotations(function_builder builder);
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <tiramisu/tiramisu.h>
+
+#include <isl/set.h>
+
+#include <string>
+#include <vector>
+
+struct ComputationCounts
+{
+    std::string name;
+    // points of the iteration domain
+    double points = 0;
+    // arithmetic operations of the expression times the points
+    double operations = 0;
+    // distinct elements read and written by the computation, times the size of their elements
+    double bytes_read = 0;
+    double bytes_written = 0;
+    // false when a set was too large to be counted and its bounding box was counted instead
+    bool exact = true;
+};
+
+struct OperationCounts
+{
+    std::vector<ComputationCounts> computations;
+    double operations = 0;
+    // compulsory traffic: every distinct element of a buffer that is read is loaded once and every distinct element
+    // that is written is stored once, whichever computations access it. Elements read after the function wrote them
+    // are not loaded and the temporary buffers are left out.
+    double compulsory_bytes = 0;
+    bool exact = true;
+};
+
+// Arithmetic operations of one evaluation of the expression, the index expressions of the accesses are not counted
+int count_operations(const tiramisu::expr &e);
+
+// Integer points of a bounded set without parameters. Sets whose bounding box has more than max_points points
+// are not enumerated, the box is counted instead and exact is set to false.
+double count_points(isl_set *set, bool &exact, double max_points = 1e7);
+
+// Operations and memory traffic of the computations of the function, from their iteration domains, expressions
+// and access relations. The domains must not have parameters.
+OperationCounts get_operation_counts(tiramisu::function *implicit_function);
+
+// JSON array of the counts of every computation
+std::string operation_counts_to_json(const OperationCounts &counts);
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <TiraLibCPP/utils.h>
+#include <TiraLibCPP/action_space.h>
+#include <TiraLibCPP/function_loader.h>
+
+#include <functional>
+#include <map>
+
+struct SearchConfig
+{
+    // "beam" or "mcts"
+    std::string method = "beam";
+    int max_depth = 4;
+    int beam_size = 4;
+    int mcts_iterations = 100;
+    double mcts_exploration = 1.41;
+    int nb_results = 5;
+    // 0 means no limit, the search stops at the first limit reached
+    double time_budget = 0;
+    int max_executions = 0;
+    uint64_t seed = 0;
+    ActionMenu menu;
+};
+
+struct SearchResult
+{
+    std::string schedule_str;
+    Result result;
+    double cost;
+};
+
+// Lower is better, schedules that could not be evaluated cost infinity. It fills the Result of the schedule.
+typedef std::function<double(std::string schedule_str, Result &result)> cost_function;
+
+// Median execution time of the schedule, every call counts as one execution of the budget
+cost_function make_execution_cost(std::string function_name, function_builder builder);
+
+// Inverse of the speedup predicted by the cost model, nothing is compiled or executed
+cost_function make_prediction_cost(std::string function_name, function_builder builder);
+
+// Explores the schedules of the function with beam search or MCTS. Legality is checked in-process on a rebuilt
+// function with the dependence analysis reused between candidates. Returns the best schedules found, best first.
+std::vector<SearchResult> search_schedules(std::string function_name, function_builder builder, SearchConfig config, cost_function cost = nullptr);
+
+struct ParameterSweepConfig
+{
+    // candidate values of every parameter of the schedule template, where parameters are written $<name>,
+    // e.g. {{"ti", {16, 32, 64}}, {"tj", {16, 32}}} for "T2(L0,L1,$ti,$tj,comps=['comp00'])"
+    std::map<std::string, std::vector<int>> parameters;
+    // "grid" measures every combination. "coordinate" starts from the first value of every parameter and measures all
+    // the values of one parameter at a time, keeping the best one, until a round over the parameters improves nothing.
+    std::string method = "grid";
+    int max_rounds = 4;
+    // concurrent compilations of the variants, 0 uses every hardware thread
+    int compile_jobs = 0;
+};
+
+struct ParameterPoint
+{
+    std::map<std::string, int> values;
+    std::string schedule_str;
+    bool legality = false;
+    std::vector<double> exec_times;
+    // infinity when the schedule is illegal or could not be executed
+    double median;
+};
+
+struct ParameterSweepResult
+{
+    std::vector<ParameterPoint> points;
+    // index of the fastest point, -1 when none could be executed
+    int best = -1;
+};
+
+// Replaces every $<name> of the template with its value
+std::string instantiate_schedule_template(std::string schedule_template, const std::map<std::string, int> &values);
+
+// Every combination of the values of the parameters, the last parameter varies fastest
+std::vector<std::map<std::string, int>> get_parameter_grid(const std::map<std::string, std::vector<int>> &parameters);
+
+// Measures the schedule template with the values of its parameters. The loop structure does not depend on them, so
+// every batch of combinations is compiled concurrently and timed in one wrapper process (see execute_variants).
+ParameterSweepResult sweep_schedule_parameters(std::string function_name, function_builder builder, std::string schedule_template, ParameterSweepConfig config);
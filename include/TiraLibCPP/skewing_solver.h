@@ -0,0 +1,12 @@
+#pragma once
+
+#include <tiramisu/tiramisu.h>
+
+#include <string>
+
+// Runs the skewing solver on every pair of consecutive loop levels of every loop nest (and of the computations
+// of a nest below the levels they share) and returns all the factors it finds as a JSON array:
+// [{"comps": [...], "levels": [l1, l2], "outer_parallelism": [[f1, f2], ...], "inner_parallelism": [...], "locality": [...]}, ...]
+// Expects the actions of schedule_str to be applied to the implicit function already.
+// The candidates are cached per function hash and schedule in the process and in TIRAMISU_DEPS_CACHE_DIR.
+std::string get_skewing_candidates(std::string function_name, std::string function_hash, std::string schedule_str, tiramisu::function *implicit_function);
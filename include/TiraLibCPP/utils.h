@@ -11,6 +11,7 @@
 #include <stdexcept>
 #include <string>
 #include <array>
+#include <cstdint>
 
 enum Operation
 {
@@ -18,6 +19,7 @@ enum Operation
     execution = 1,
     annotations = 2,
     skewing_solver = 3,
+    prediction = 4,
 };
 
 struct Result
@@ -28,22 +30,86 @@ struct Result
     std::string exec_times;
     std::string additional_info;
     bool success;
+    // speedup over the unscheduled program predicted by the cost model (Operation::prediction)
+    double predicted_speedup = 0;
+    // JSON array of the skewing factors found for every loop pair (Operation::skewing_solver)
+    std::string skewing_candidates = "[]";
+    // JSON array with the hardware counters of every execution, e.g. [{"cycles": 1200, "instructions": 3400, ...}, ...]
+    std::string perf_counters = "[]";
+    // JSON array with the time and parallel efficiency of every thread count and affinity policy (TIRAMISU_THREAD_COUNTS)
+    std::string thread_sweep = "[]";
+    // JSON array with the times of every problem size of a parametric function (TIRAMISU_PROBLEM_SIZES), e.g.
+    // [{"size": "N=64,M=32", "exec_times": [...], "median": 1.2, "success": true}, ...]
+    std::string problem_sizes = "[]";
+    // slot of the machine the wrapper ran on (TIRAMISU_MEASUREMENT_SLOTS), -1 when it could use all the CPUs
+    int measurement_slot = -1;
+    // "warm" or "cold" (TIRAMISU_CACHE_MODE), empty when the wrapper does not report it
+    std::string cache_mode;
+    // how the wrapper allocated and filled the buffers, e.g. "hugepages=transparent;numa=interleave;fill=random:0;anon_huge_kb=4096"
+    std::string allocation;
+    // comparison of the outputs with the ones of the unscheduled function (TIRAMISU_VALIDATE), validated is false
+    // when there was no reference to compare with
+    bool validated = false;
+    bool validation_passed = false;
+    double validation_max_abs_error = 0;
+    double validation_max_rel_error = 0;
+    // FNV-1a hash of the outputs after the first run, when they are recorded or validated
+    std::string output_checksum;
+    // roofline metrics (TIRAMISU_ROOFLINE): arithmetic operations and compulsory bytes of the function from its
+    // iteration domains and access relations, the rates achieved by the median time and the peaks of the machine
+    // in GFLOP/s and GB/s. operation_counts is a JSON array with the counts of every computation, e.g.
+    // [{"name": "comp", "points": 4096, "operations": 8192, "bytes_read": 32768, "bytes_written": 32768, "exact": true}, ...]
+    double flops = 0;
+    double compulsory_bytes = 0;
+    double arithmetic_intensity = 0;
+    double achieved_gflops = 0;
+    double achieved_bandwidth = 0;
+    double peak_gflops = 0;
+    double peak_bandwidth = 0;
+    std::string operation_counts = "[]";
+    // resources used by the wrapper process over all its runs (Operation::execution)
+    long max_rss_kb = 0;
+    long minor_page_faults = 0;
+    long major_page_faults = 0;
+    long voluntary_context_switches = 0;
+    long involuntary_context_switches = 0;
+    // CPU time of all the threads of the wrapper, in seconds
+    double user_time = 0;
+    double system_time = 0;
 };
 
 tiramisu::computation *get_computation_by_name(std::string comp_name, tiramisu::function *implicit_function);
 
+int get_loop_extent(tiramisu::computation *comp, int level);
+
 bool isSingleQuoteOrWhiteSpace(char c);
 
+uint64_t fnv1a_hash(const std::string &str, uint64_t hash = 14695981039346656037ULL);
+
+std::string hash_to_str(uint64_t hash);
+
 std::string get_first_comp(std::string comps_str);
 
 std::vector<tiramisu::computation *> get_comps(std::string comps_str, tiramisu::function *implicit_function);
 
 Operation get_operation_from_string(std::string operation_str);
 
+std::string get_string_from_operation(Operation operation);
+
 bool file_exists(const std::string &name);
 
 std::tuple<bool, std::string> exec(const char *cmd);
 
+std::string shell_quote(std::string str);
+
 int compile_wrapper(std::string function_name);
 
-std::string serialize_result(Result &result);
\ No newline at end of file
+void append_additional_info(Result &result, std::string info);
+
+std::vector<double> parse_exec_times(std::string exec_times);
+
+std::string serialize_result(Result &result);
+
+std::string get_serialized_field(const std::string &result_str, std::string key);
+
+Result deserialize_result(std::string result_str);
\ No newline at end of file
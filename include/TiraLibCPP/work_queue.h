@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// A shared-filesystem work queue used to spread (function, schedule) evaluations over many workers and nodes.
+//
+// Layout of a queue directory:
+//   pending/<id>              items waiting for a worker
+//   claimed/<id>.<worker_id>  items being evaluated, the file mtime is the worker's heartbeat
+//   results/<id>              committed results (the serialized Result of the generated executable)
+//
+// Every transition is a rename or a hard link, which are atomic on a shared filesystem, so the coordinator
+// and the workers never need to talk to each other directly.
+
+struct WorkItem
+{
+    std::string id;
+    std::string function_name;
+    std::string operation;
+    std::string schedule_str;
+};
+
+struct WorkerConfig
+{
+    // unique among all the workers of the queue, run_worker uses <hostname>-<pid> when it is empty
+    std::string worker_id;
+    // directory containing the generated executable of every function
+    std::string executables_dir;
+    // seconds between two heartbeats of a running item
+    int heartbeat_seconds = 5;
+    // claims without a heartbeat for this long are re-executed speculatively by idle workers
+    int straggler_seconds = 60;
+    // the heartbeat goes on while the executable runs, so a hung one is killed after this long (never when 0) and
+    // its item gets a result with evaluation_timeout in additional_info
+    int evaluation_timeout_seconds = 1800;
+    // keep polling for new items instead of exiting when the queue is drained
+    bool wait_for_work = false;
+};
+
+std::string get_work_item_id(std::string function_name, std::string operation, std::string schedule_str);
+
+void init_work_queue(std::string queue_dir);
+
+// Returns the number of items queued, items that are already pending, claimed or done are skipped
+int submit_work_items(std::string queue_dir, std::vector<WorkItem> items);
+
+bool claim_work_item(std::string queue_dir, WorkerConfig &config, WorkItem &item);
+
+// Returns false if another worker already committed a result for this item
+bool commit_work_result(std::string queue_dir, std::string worker_id, std::string item_id, std::string result_str);
+
+// Moves the items of workers that stopped sending heartbeats back to pending/, returns the number of requeued items
+int requeue_expired_work_items(std::string queue_dir, int lease_seconds);
+
+bool work_queue_is_done(std::string queue_dir);
+
+std::vector<std::string> collect_work_results(std::string queue_dir);
+
+void run_worker(std::string queue_dir, WorkerConfig config);
+
+void run_coordinator(std::string queue_dir, int lease_seconds);
@@ -0,0 +1,983 @@
+#pragma once
+
+// Header-only runtime of the wrappers generated by TiraLibCPP (see execution.h). It does not depend on Tiramisu,
+// wrappers only need the Halide runtime header and the object of the function.
+// The measurements are written to the file named by TIRAMISU_REPORT_FILE, one "<key> <value>" line per measurement.
+
+#include <HalideRuntime.h>
+
+#include <dirent.h>
+#include <dlfcn.h>
+#include <linux/mempolicy.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// the thread pool lives in the runtime compiled into the function, wrappers without it simply keep their threads
+#pragma weak halide_shutdown_thread_pool
+
+namespace tiralib
+{
+    inline int get_env_int(const char *name, int default_value)
+    {
+        const char *value = getenv(name);
+        return value == nullptr || *value == '\0' ? default_value : atoi(value);
+    }
+
+    // nullptr when the variable is not set or empty
+    inline const char *get_env_path(const char *name)
+    {
+        const char *value = getenv(name);
+        return value == nullptr || *value == '\0' ? nullptr : value;
+    }
+
+    inline int get_nb_exec()
+    {
+        return get_env_int("TIRAMISU_NB_EXEC", 10);
+    }
+
+    class Report
+    {
+    public:
+        void set(std::string key, std::string value)
+        {
+            values[key] = value;
+        }
+
+        // does nothing when the wrapper is not run by TiraLibCPP
+        void write()
+        {
+            const char *path = getenv("TIRAMISU_REPORT_FILE");
+            if (path == nullptr)
+                return;
+            std::ofstream report_file(path);
+            for (auto &value : values)
+                report_file << value.first << " " << value.second << "\n";
+        }
+
+    private:
+        std::map<std::string, std::string> values;
+    };
+
+    // Hardware counters of the wrapper and of the threads it starts, opened as one group so that they are
+    // scheduled together. Counters the machine or the permissions do not allow are left out.
+    class PerfCounters
+    {
+    public:
+        PerfCounters()
+        {
+            add("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+            add("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+            add("l1d_misses", PERF_TYPE_HW_CACHE, get_cache_config(PERF_COUNT_HW_CACHE_L1D));
+            add("llc_misses", PERF_TYPE_HW_CACHE, get_cache_config(PERF_COUNT_HW_CACHE_LL));
+            add("dtlb_misses", PERF_TYPE_HW_CACHE, get_cache_config(PERF_COUNT_HW_CACHE_DTLB));
+            add("branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        }
+
+        ~PerfCounters()
+        {
+            for (auto &counter : counters)
+                close(counter.fd);
+        }
+
+        bool available() const
+        {
+            return !counters.empty();
+        }
+
+        void start()
+        {
+            for (auto &counter : counters)
+                read_counter(counter, counter.start);
+        }
+
+        // counts since start(), scaled when the kernel multiplexed the counters
+        std::map<std::string, uint64_t> stop()
+        {
+            std::map<std::string, uint64_t> values;
+            for (auto &counter : counters)
+            {
+                uint64_t end[3];
+                if (!read_counter(counter, end))
+                    continue;
+                uint64_t value = end[0] - counter.start[0];
+                uint64_t enabled = end[1] - counter.start[1];
+                uint64_t running = end[2] - counter.start[2];
+                // a group that could not be scheduled did not count at all
+                if (running == 0)
+                    continue;
+                if (running < enabled)
+                    value = (uint64_t)((double)value * enabled / running);
+                values[counter.name] = value;
+            }
+            return values;
+        }
+
+    private:
+        struct Counter
+        {
+            std::string name;
+            int fd;
+            uint64_t start[3];
+        };
+
+        static uint64_t get_cache_config(uint64_t cache)
+        {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        }
+
+        void add(std::string name, uint32_t type, uint64_t config)
+        {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            // threads started later by the kernel are counted too, user space only so that it works unprivileged
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            int group_fd = counters.empty() ? -1 : counters[0].fd;
+            int fd = syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+            // the event may exist outside of the group (e.g. the group leader is not supported)
+            if (fd < 0 && group_fd != -1)
+                fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            if (fd >= 0)
+                counters.push_back({name, fd, {0, 0, 0}});
+        }
+
+        static bool read_counter(Counter &counter, uint64_t values[3])
+        {
+            return read(counter.fd, values, 3 * sizeof(uint64_t)) == 3 * sizeof(uint64_t);
+        }
+
+        std::vector<Counter> counters;
+    };
+
+    inline std::string counters_to_json(const std::map<std::string, uint64_t> &values)
+    {
+        std::string json = "{";
+        for (auto &value : values)
+            json += (json.size() > 1 ? ", \"" : "\"") + value.first + "\": " + std::to_string(value.second);
+        return json + "}";
+    }
+
+    // Size in bytes of the largest data cache of the first CPU, from sysfs or sysconf (32 MiB when unknown)
+    inline size_t get_llc_size()
+    {
+        size_t llc_size = 0;
+        int llc_level = 0;
+        std::string cache_dir = "/sys/devices/system/cpu/cpu0/cache/";
+        if (DIR *dir = opendir(cache_dir.c_str()))
+        {
+            while (dirent *entry = readdir(dir))
+            {
+                std::string index = entry->d_name;
+                if (index.rfind("index", 0) != 0)
+                    continue;
+                std::string type, size;
+                int level = 0;
+                std::ifstream(cache_dir + index + "/type") >> type;
+                std::ifstream(cache_dir + index + "/level") >> level;
+                std::ifstream(cache_dir + index + "/size") >> size;
+                if (type == "Instruction" || size.empty() || level < llc_level)
+                    continue;
+                size_t bytes = std::stoull(size);
+                if (size.back() == 'K')
+                    bytes *= 1024;
+                else if (size.back() == 'M')
+                    bytes *= 1024 * 1024;
+                if (level > llc_level || bytes > llc_size)
+                    llc_size = bytes;
+                llc_level = level;
+            }
+            closedir(dir);
+        }
+        if (llc_size == 0)
+        {
+            long size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+            llc_size = size > 0 ? size : 32 * 1024 * 1024;
+        }
+        return llc_size;
+    }
+
+    // Evicts the data of the kernel from the caches by writing and reading a buffer twice as large as the
+    // last-level cache
+    class CacheFlusher
+    {
+    public:
+        CacheFlusher() : buffer(2 * get_llc_size(), 0) {}
+
+        void flush()
+        {
+            for (size_t i = 0; i < buffer.size(); i += 64)
+                buffer[i]++;
+            uint8_t sum = 0;
+            for (size_t i = 0; i < buffer.size(); i += 64)
+                sum += buffer[i];
+            sink = sum;
+        }
+
+        size_t size() const
+        {
+            return buffer.size();
+        }
+
+    private:
+        std::vector<uint8_t> buffer;
+        volatile uint8_t sink;
+    };
+
+    // How the buffers are allocated and filled, from the environment:
+    // TIRAMISU_HUGEPAGES: "none", "transparent" (madvise) or "explicit" (MAP_HUGETLB, transparent when none is reserved)
+    // TIRAMISU_NUMA: "default", "interleave" (over all the nodes), "local" (node of the thread that touches the page)
+    // or "first_touch" (filled in parallel by HL_NUM_THREADS threads, so that every thread touches its share first)
+    // TIRAMISU_FILL: "random" (seeded by TIRAMISU_FILL_SEED and the buffer name), "index" or "zero"
+    struct AllocationOptions
+    {
+        std::string hugepages = "none";
+        std::string numa = "default";
+        std::string fill = "random";
+        uint64_t seed = 0;
+        // fallbacks that happened, e.g. "explicit->transparent"
+        std::string fallbacks;
+
+        std::string describe() const
+        {
+            std::string description = "hugepages=" + hugepages + ";numa=" + numa + ";fill=" + fill;
+            if (fill == "random")
+                description += ":" + std::to_string(seed);
+            if (!fallbacks.empty())
+                description += ";fallbacks=" + fallbacks;
+            return description;
+        }
+    };
+
+    inline std::string get_env_str(const char *name, std::string default_value)
+    {
+        const char *value = getenv(name);
+        return value == nullptr || *value == '\0' ? default_value : value;
+    }
+
+    inline AllocationOptions &get_allocation_options()
+    {
+        static AllocationOptions options = []()
+        {
+            AllocationOptions options;
+            options.hugepages = get_env_str("TIRAMISU_HUGEPAGES", options.hugepages);
+            options.numa = get_env_str("TIRAMISU_NUMA", options.numa);
+            options.fill = get_env_str("TIRAMISU_FILL", options.fill);
+            options.seed = std::stoull(get_env_str("TIRAMISU_FILL_SEED", "0"));
+            return options;
+        }();
+        return options;
+    }
+
+    inline void add_fallback(std::string fallback)
+    {
+        auto &options = get_allocation_options();
+        if (options.fallbacks.find(fallback) == std::string::npos)
+            options.fallbacks += (options.fallbacks.empty() ? "" : ",") + fallback;
+    }
+
+    // Kilobytes of the process backed by transparent huge pages
+    inline long get_anon_huge_kb()
+    {
+        std::ifstream smaps("/proc/self/smaps_rollup");
+        std::string line;
+        while (std::getline(smaps, line))
+        {
+            if (line.rfind("AnonHugePages:", 0) == 0)
+                return std::stol(line.substr(14));
+        }
+        return 0;
+    }
+
+    // Memory for the buffers, from mmap when the pages need a policy and from aligned_alloc otherwise
+    class Allocation
+    {
+    public:
+        Allocation(size_t bytes)
+        {
+            auto &options = get_allocation_options();
+            size = (bytes + (1 << 21) - 1) / (1 << 21) * (1 << 21);
+            if (options.hugepages == "none" && (options.numa == "default" || options.numa == "first_touch"))
+            {
+                data = aligned_alloc(64, (bytes + 63) / 64 * 64);
+                return;
+            }
+
+            mapped = true;
+            if (options.hugepages == "explicit")
+            {
+                data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (data == MAP_FAILED)
+                    add_fallback("explicit->transparent");
+            }
+            if (data == nullptr || data == MAP_FAILED)
+            {
+                // 2 MiB aligned so that transparent huge pages can back the whole buffer
+                void *region = mmap(nullptr, size + (1 << 21), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (region == MAP_FAILED)
+                    throw std::bad_alloc();
+                uintptr_t aligned = ((uintptr_t)region + (1 << 21) - 1) & ~(uintptr_t)((1 << 21) - 1);
+                size_t head = aligned - (uintptr_t)region;
+                if (head > 0)
+                    munmap(region, head);
+                munmap((void *)(aligned + size), (1 << 21) - head);
+                data = (void *)aligned;
+                if (options.hugepages != "none" && madvise(data, size, MADV_HUGEPAGE) != 0)
+                    add_fallback("transparent->none");
+            }
+
+            if (options.numa == "interleave" || options.numa == "local")
+                set_numa_policy(options.numa);
+        }
+
+        Allocation(const Allocation &) = delete;
+        Allocation &operator=(const Allocation &) = delete;
+
+        ~Allocation()
+        {
+            if (mapped)
+                munmap(data, size);
+            else
+                free(data);
+        }
+
+        void *get()
+        {
+            return data;
+        }
+
+    private:
+        void set_numa_policy(std::string numa)
+        {
+            unsigned long nodemask[16] = {0};
+            std::ifstream online("/sys/devices/system/node/online");
+            std::string ranges;
+            online >> ranges;
+            std::stringstream ss(ranges.empty() ? "0" : ranges);
+            std::string range;
+            while (std::getline(ss, range, ','))
+            {
+                size_t dash = range.find('-');
+                int first = std::stoi(range.substr(0, dash));
+                int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                for (int node = first; node <= last && node < 16 * 64; node++)
+                    nodemask[node / 64] |= 1UL << (node % 64);
+            }
+
+            long status = numa == "interleave" ? syscall(SYS_mbind, data, size, MPOL_INTERLEAVE, nodemask, 16 * 64, 0)
+                                               : syscall(SYS_mbind, data, size, MPOL_LOCAL, nullptr, 0, 0);
+            if (status != 0)
+                add_fallback(numa + "->default");
+        }
+
+        void *data = nullptr;
+        size_t size;
+        bool mapped = false;
+    };
+
+    // Counter-based so that a buffer gets the same values whatever the number of threads that fill it
+    inline uint64_t mix(uint64_t value)
+    {
+        value += 0x9e3779b97f4a7c15ULL;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+    inline uint64_t name_seed(const std::string &name)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : name)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // values in [0, 2) for floating point types and in [0, 200) otherwise
+    template <typename T>
+    T fill_value(const AllocationOptions &options, uint64_t seed, size_t index)
+    {
+        uint64_t value = 0;
+        if (options.fill == "random")
+            value = mix(seed + index) % 200;
+        else if (options.fill == "index")
+            value = index % 200;
+        if (std::is_floating_point<T>::value)
+            return (T)value / 100;
+        return (T)value;
+    }
+
+    // Buffers of the wrapper, their outputs are compared with the outputs of the unscheduled function
+    struct BufferView
+    {
+        std::string name;
+        halide_type_t type;
+        const void *data;
+        size_t nb_elements;
+        bool is_output;
+        // fills the buffer with its initial values again
+        std::function<void()> fill;
+
+        size_t get_bytes() const
+        {
+            return nb_elements * ((type.bits + 7) / 8);
+        }
+    };
+
+    inline std::vector<BufferView> &get_buffers()
+    {
+        static std::vector<BufferView> buffers;
+        return buffers;
+    }
+
+    inline std::vector<BufferView> get_outputs()
+    {
+        std::vector<BufferView> outputs;
+        for (auto &buffer : get_buffers())
+        {
+            if (buffer.is_output)
+                outputs.push_back(buffer);
+        }
+        return outputs;
+    }
+
+    struct Comparison
+    {
+        double max_abs_error = 0;
+        double max_rel_error = 0;
+        size_t nb_errors = 0;
+    };
+
+    // |value - reference| <= atol + rtol * |reference| for every element, NaNs never pass
+    template <typename T>
+    void compare_values(const T *values, const T *reference, size_t nb_elements, double atol, double rtol, Comparison &comparison)
+    {
+        double max_abs_error = comparison.max_abs_error;
+        double max_rel_error = comparison.max_rel_error;
+        size_t nb_errors = 0;
+#pragma omp simd reduction(max : max_abs_error, max_rel_error) reduction(+ : nb_errors)
+        for (size_t i = 0; i < nb_elements; i++)
+        {
+            double value = values[i];
+            double expected = reference[i];
+            double error = value > expected ? value - expected : expected - value;
+            double magnitude = expected < 0 ? -expected : expected;
+            double relative_error = magnitude > 0 ? error / magnitude : error;
+            max_abs_error = error > max_abs_error ? error : max_abs_error;
+            max_rel_error = relative_error > max_rel_error ? relative_error : max_rel_error;
+            nb_errors += !(error <= atol + rtol * magnitude);
+        }
+        comparison.max_abs_error = max_abs_error;
+        comparison.max_rel_error = max_rel_error;
+        comparison.nb_errors += nb_errors;
+    }
+
+    inline uint64_t checksum(const uint8_t *data, size_t bytes, uint64_t hash = 14695981039346656037ULL)
+    {
+        for (size_t i = 0; i < bytes; i++)
+        {
+            hash ^= data[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // Copy of the outputs after the first run of the kernel, so that kernels that accumulate into their outputs are
+    // compared after the same number of runs. The reference file is a "<name> <type code> <bits> <nb_elements>" line
+    // followed by the raw values for every output.
+    class OutputSnapshot
+    {
+    public:
+        OutputSnapshot() : outputs(get_outputs())
+        {
+            for (auto &output : outputs)
+            {
+                auto bytes = (const uint8_t *)output.data;
+                values.emplace_back(bytes, bytes + output.get_bytes());
+            }
+        }
+
+        std::string get_checksum() const
+        {
+            uint64_t hash = 14695981039346656037ULL;
+            for (auto &output_values : values)
+                hash = checksum(output_values.data(), output_values.size(), hash);
+            std::stringstream ss;
+            ss << std::hex << hash;
+            return ss.str();
+        }
+
+        bool write(std::string path) const
+        {
+            std::ofstream file(path, std::ios::binary);
+            for (size_t i = 0; i < outputs.size(); i++)
+            {
+                file << outputs[i].name << " " << (int)outputs[i].type.code << " " << (int)outputs[i].type.bits << " " << outputs[i].nb_elements << "\n";
+                file.write((const char *)values[i].data(), values[i].size());
+            }
+            return file.good();
+        }
+
+        // Floating point values are compared with the tolerances (TIRAMISU_VALIDATION_ATOL and TIRAMISU_VALIDATION_RTOL
+        // override the defaults of each type), the other types have to be equal
+        bool compare(std::string reference_path, Comparison &comparison, std::string &error) const
+        {
+            std::ifstream file(reference_path, std::ios::binary);
+            for (size_t i = 0; i < outputs.size(); i++)
+            {
+                std::string name;
+                int code, bits;
+                size_t nb_elements;
+                file >> name >> code >> bits >> nb_elements;
+                file.get();
+                if (!file || name != outputs[i].name || code != outputs[i].type.code || bits != outputs[i].type.bits || nb_elements != outputs[i].nb_elements)
+                {
+                    error = "reference_mismatch:" + outputs[i].name;
+                    return false;
+                }
+                std::vector<uint8_t> reference(values[i].size());
+                file.read((char *)reference.data(), reference.size());
+
+                if (code == halide_type_float && bits == 64)
+                    compare_values((const double *)values[i].data(), (const double *)reference.data(), nb_elements, get_tolerance("ATOL", 1e-8), get_tolerance("RTOL", 1e-5), comparison);
+                else if (code == halide_type_float && bits == 32)
+                    compare_values((const float *)values[i].data(), (const float *)reference.data(), nb_elements, get_tolerance("ATOL", 1e-5), get_tolerance("RTOL", 1e-3), comparison);
+                else if (bits == 64)
+                    compare_values((const uint64_t *)values[i].data(), (const uint64_t *)reference.data(), nb_elements, 0, 0, comparison);
+                else if (bits == 32)
+                    compare_values((const uint32_t *)values[i].data(), (const uint32_t *)reference.data(), nb_elements, 0, 0, comparison);
+                else if (bits == 16)
+                    compare_values((const uint16_t *)values[i].data(), (const uint16_t *)reference.data(), nb_elements, 0, 0, comparison);
+                else
+                    compare_values(values[i].data(), reference.data(), nb_elements, 0, 0, comparison);
+            }
+            return true;
+        }
+
+    private:
+        static double get_tolerance(std::string name, double default_value)
+        {
+            const char *value = get_env_path(("TIRAMISU_VALIDATION_" + name).c_str());
+            return value == nullptr ? default_value : atof(value);
+        }
+
+        std::vector<BufferView> outputs;
+        std::vector<std::vector<uint8_t>> values;
+    };
+
+    // Dense row-major buffer with the sizes of a tiramisu::buffer, seen by the function as a halide_buffer_t
+    // whose first dimension is the innermost one. It is allocated and filled as set by AllocationOptions.
+    template <typename T>
+    class Buffer
+    {
+    public:
+        Buffer(std::string name, std::vector<int32_t> sizes, bool is_output = false) : name(name), dims(sizes.size())
+        {
+            for (int d = sizes.size() - 1; d >= 0; d--)
+            {
+                int halide_dim = sizes.size() - 1 - d;
+                dims[halide_dim] = {0, sizes[d], (int32_t)nb_elements, 0};
+                nb_elements *= sizes[d];
+            }
+            allocation = std::make_unique<Allocation>(nb_elements * sizeof(T));
+            data = (T *)allocation->get();
+            fill();
+
+            memset(&buffer, 0, sizeof(buffer));
+            buffer.host = (uint8_t *)data;
+            buffer.type = halide_type_of<T>();
+            buffer.dimensions = dims.size();
+            buffer.dim = dims.data();
+            get_buffers().push_back({name, buffer.type, data, nb_elements, is_output, [this]()
+                                     { fill(); }});
+        }
+
+        ~Buffer()
+        {
+            auto &buffers = get_buffers();
+            buffers.erase(std::remove_if(buffers.begin(), buffers.end(), [this](const BufferView &view)
+                                         { return view.data == data; }),
+                          buffers.end());
+        }
+
+        Buffer(const Buffer &) = delete;
+        Buffer &operator=(const Buffer &) = delete;
+
+        halide_buffer_t *raw()
+        {
+            return &buffer;
+        }
+
+        std::string name;
+
+    private:
+        void fill()
+        {
+            auto &options = get_allocation_options();
+            uint64_t seed = options.seed ^ name_seed(name);
+            auto fill_range = [&](size_t first, size_t last)
+            {
+                for (size_t i = first; i < last; i++)
+                    data[i] = fill_value<T>(options, seed, i);
+            };
+            if (options.numa != "first_touch")
+            {
+                fill_range(0, nb_elements);
+                return;
+            }
+
+            // contiguous shares, like the iterations of a parallel outermost loop
+            int nb_threads = get_env_int("HL_NUM_THREADS", std::thread::hardware_concurrency());
+            std::vector<std::thread> threads;
+            for (int t = 0; t < nb_threads; t++)
+                threads.emplace_back(fill_range, nb_elements * t / nb_threads, nb_elements * (t + 1) / nb_threads);
+            for (auto &thread : threads)
+                thread.join();
+        }
+
+        std::vector<halide_dimension_t> dims;
+        size_t nb_elements = 1;
+        std::unique_ptr<Allocation> allocation;
+        T *data;
+        halide_buffer_t buffer;
+    };
+
+    // Runs the kernel get_nb_exec() times and reports the time of every run in milliseconds (also printed on stdout
+    // like the wrappers written by hand). With TIRAMISU_PERF_COUNTERS=1 the hardware counters are read around one
+    // more run after the timed ones. The counts of the pool threads are only folded into the wrapper's counters when
+    // the threads exit, so the pool is stopped before that run (dropping the counts of the earlier runs from the
+    // reading) and after it, and the timed runs never restart it.
+    // TIRAMISU_CACHE_MODE=warm (the default) runs the kernel once before the timed runs, "cold" flushes the
+    // last-level cache before every timed run instead.
+    // The outputs after the first run are written to TIRAMISU_RECORD_REFERENCE, or compared with the ones in
+    // TIRAMISU_VALIDATE_REFERENCE.
+    // The keys of the report start with prefix, shutdown_thread_pool is the thread pool of the kernel's runtime.
+    template <typename Kernel>
+    int run_measurement(Kernel kernel, Report &report, std::string prefix, void (*shutdown_thread_pool)())
+    {
+        std::unique_ptr<PerfCounters> counters;
+        if (get_env_int("TIRAMISU_PERF_COUNTERS", 0))
+            counters = std::make_unique<PerfCounters>();
+
+        const char *cache_mode = getenv("TIRAMISU_CACHE_MODE");
+        std::unique_ptr<CacheFlusher> flusher;
+        if (cache_mode != nullptr && std::string(cache_mode) == "cold")
+        {
+            flusher = std::make_unique<CacheFlusher>();
+            report.set(prefix + "cache_mode", "cold");
+            report.set(prefix + "cache_flush_bytes", std::to_string(flusher->size()));
+        }
+
+        const char *record_path = get_env_path("TIRAMISU_RECORD_REFERENCE");
+        const char *reference_path = get_env_path("TIRAMISU_VALIDATE_REFERENCE");
+        std::unique_ptr<OutputSnapshot> snapshot;
+        auto take_snapshot = [&]()
+        {
+            if (snapshot == nullptr && (record_path != nullptr || reference_path != nullptr))
+                snapshot = std::make_unique<OutputSnapshot>();
+        };
+
+        if (flusher == nullptr)
+        {
+            report.set(prefix + "cache_mode", "warm");
+            int status = kernel();
+            if (status != 0)
+                return status;
+            take_snapshot();
+        }
+
+        std::string exec_times;
+        int nb_exec = get_nb_exec();
+        for (int i = 0; i < nb_exec; i++)
+        {
+            if (flusher)
+                flusher->flush();
+            auto begin = std::chrono::high_resolution_clock::now();
+            int status = kernel();
+            auto end = std::chrono::high_resolution_clock::now();
+            if (status != 0)
+                return status;
+            take_snapshot();
+            exec_times += (i > 0 ? " " : "") + std::to_string(std::chrono::duration<double, std::milli>(end - begin).count());
+        }
+        std::cout << exec_times << std::endl;
+
+        std::string perf_counters = "[]";
+        if (counters && counters->available())
+        {
+            if (shutdown_thread_pool)
+                shutdown_thread_pool();
+            if (flusher)
+                flusher->flush();
+            counters->start();
+            int status = kernel();
+            if (status != 0)
+                return status;
+            if (shutdown_thread_pool)
+                shutdown_thread_pool();
+            perf_counters = "[" + counters_to_json(counters->stop()) + "]";
+        }
+
+        report.set(prefix + "exec_times", exec_times);
+        report.set(prefix + "allocation", get_allocation_options().describe() + ";anon_huge_kb=" + std::to_string(get_anon_huge_kb()));
+        if (counters)
+            report.set(prefix + "perf_counters", perf_counters);
+
+        if (snapshot)
+            report.set(prefix + "output_checksum", snapshot->get_checksum());
+        if (snapshot && record_path != nullptr && !snapshot->write(record_path))
+            report.set(prefix + "validation_error", "reference_not_written");
+        if (snapshot && reference_path != nullptr)
+        {
+            Comparison comparison;
+            std::string error;
+            if (snapshot->compare(reference_path, comparison, error))
+            {
+                report.set(prefix + "validation_passed", comparison.nb_errors == 0 ? "1" : "0");
+                report.set(prefix + "validation_nb_errors", std::to_string(comparison.nb_errors));
+                // std::to_string would round the small errors to 0
+                std::stringstream max_abs_error, max_rel_error;
+                max_abs_error << comparison.max_abs_error;
+                max_rel_error << comparison.max_rel_error;
+                report.set(prefix + "validation_max_abs_error", max_abs_error.str());
+                report.set(prefix + "validation_max_rel_error", max_rel_error.str());
+            }
+            else
+                report.set(prefix + "validation_error", error);
+        }
+        return 0;
+    }
+
+    template <typename Kernel>
+    int measure(Kernel kernel)
+    {
+        Report report;
+        int status = run_measurement(kernel, report, "", halide_shutdown_thread_pool);
+        if (status != 0)
+            return status;
+        report.write();
+        return 0;
+    }
+
+    // Peak double precision rate of the machine in GFLOP/s: every thread updates independent multiply-add chains
+    // that the compiler turns into fused multiply-adds of the widest vectors of the target
+    inline double measure_peak_gflops()
+    {
+        const int width = 64;
+        const long iterations = 20000000 / width * 8;
+        double best = 0;
+        for (int repetition = 0; repetition < 3; repetition++)
+        {
+            int nb_threads = 0;
+            double sink = 0;
+            auto begin = std::chrono::high_resolution_clock::now();
+#pragma omp parallel reduction(+ : sink)
+            {
+                double chains[width];
+                for (int j = 0; j < width; j++)
+                    chains[j] = 1 + j * 1e-3;
+                for (long i = 0; i < iterations; i++)
+                {
+#pragma omp simd
+                    for (int j = 0; j < width; j++)
+                        chains[j] = chains[j] * 0.999999 + 1e-7;
+                }
+                for (int j = 0; j < width; j++)
+                    sink += chains[j];
+#pragma omp atomic
+                nb_threads++;
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            double seconds = std::chrono::duration<double>(end - begin).count();
+            // keeps the chains alive
+            if (sink == 0)
+                std::cerr << sink << std::endl;
+            best = std::max(best, 2.0 * width * iterations * nb_threads / seconds / 1e9);
+        }
+        return best;
+    }
+
+    // Peak memory bandwidth in GB/s, from a parallel triad a = b + s * c over arrays much larger than the
+    // last-level cache. The traffic counts the two loads and the store of every element.
+    inline double measure_peak_bandwidth()
+    {
+        size_t nb_elements = std::max<size_t>(4 * get_llc_size(), 64 << 20) / sizeof(double);
+        std::vector<double> a(nb_elements), b(nb_elements), c(nb_elements);
+#pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < nb_elements; i++)
+        {
+            b[i] = 1;
+            c[i] = 2;
+        }
+        double best = 0;
+        for (int repetition = 0; repetition < 5; repetition++)
+        {
+            auto begin = std::chrono::high_resolution_clock::now();
+#pragma omp parallel for simd schedule(static)
+            for (size_t i = 0; i < nb_elements; i++)
+                a[i] = b[i] + 3 * c[i];
+            auto end = std::chrono::high_resolution_clock::now();
+            double seconds = std::chrono::duration<double>(end - begin).count();
+            best = std::max(best, 3.0 * nb_elements * sizeof(double) / seconds / 1e9);
+        }
+        return best;
+    }
+
+    // Main of the machine peaks benchmark, it reports peak_gflops and peak_bandwidth
+    inline int measure_machine_peaks()
+    {
+        Report report;
+        report.set("peak_gflops", std::to_string(measure_peak_gflops()));
+        report.set("peak_bandwidth", std::to_string(measure_peak_bandwidth()));
+        report.write();
+        return 0;
+    }
+
+    // One set of values of the size parameters of a function, in the order of TIRAMISU_PROBLEM_SIZES
+    typedef std::vector<std::pair<std::string, int32_t>> ProblemSize;
+
+    // TIRAMISU_PROBLEM_SIZES lists the problem sizes separated by ';', e.g. "N=64,M=32;N=128,M=64"
+    inline std::vector<ProblemSize> get_problem_sizes()
+    {
+        std::vector<ProblemSize> sizes;
+        const char *value = get_env_path("TIRAMISU_PROBLEM_SIZES");
+        std::stringstream sizes_stream(value == nullptr ? "" : value);
+        std::string size_str;
+        while (std::getline(sizes_stream, size_str, ';'))
+        {
+            ProblemSize size;
+            std::stringstream size_stream(size_str);
+            std::string parameter;
+            while (std::getline(size_stream, parameter, ','))
+            {
+                size_t equal = parameter.find('=');
+                if (equal != std::string::npos)
+                    size.push_back({parameter.substr(0, equal), atoi(parameter.substr(equal + 1).c_str())});
+            }
+            if (!size.empty())
+                sizes.push_back(size);
+        }
+        return sizes;
+    }
+
+    inline int32_t get_size(const ProblemSize &size, std::string name)
+    {
+        for (auto &parameter : size)
+        {
+            if (parameter.first == name)
+                return parameter.second;
+        }
+        throw std::invalid_argument("No value for the size parameter " + name);
+    }
+
+    inline std::string describe(const ProblemSize &size)
+    {
+        std::string description;
+        for (auto &parameter : size)
+            description += (description.empty() ? "" : ",") + parameter.first + "=" + std::to_string(parameter.second);
+        return description;
+    }
+
+    // The SIZES buffer of a parametric function gets the values of the parameters in the order of names (the
+    // parameters sorted by name in the generated wrappers), whatever their order in TIRAMISU_PROBLEM_SIZES
+    inline void set_size_values(halide_buffer_t *sizes, const ProblemSize &size, const std::vector<std::string> &names)
+    {
+        for (size_t i = 0; i < names.size() && i < (size_t)sizes->dim[0].extent; i++)
+            ((int32_t *)sizes->host)[i] = get_size(size, names[i]);
+    }
+
+    typedef std::function<int(std::function<int()>)> Measurement;
+
+    // Calls run with every problem size of TIRAMISU_PROBLEM_SIZES and a measurement that times the kernel allocated
+    // by run for that size. The report keys of the i-th size start with "size_<i>_", "size_<i>_problem_size" gives
+    // its values and sizes whose kernel failed get a "size_<i>_error".
+    template <typename Run>
+    int measure_problem_sizes(Run run)
+    {
+        Report report;
+        auto sizes = get_problem_sizes();
+        report.set("nb_problem_sizes", std::to_string(sizes.size()));
+        for (size_t i = 0; i < sizes.size(); i++)
+        {
+            std::string prefix = "size_" + std::to_string(i) + "_";
+            report.set(prefix + "problem_size", describe(sizes[i]));
+            Measurement measurement = [&](std::function<int()> kernel)
+            {
+                return run_measurement(kernel, report, prefix, halide_shutdown_thread_pool);
+            };
+            int status = run(sizes[i], measurement);
+            if (status != 0)
+                report.set(prefix + "error", "status_" + std::to_string(status));
+        }
+        report.write();
+        return sizes.empty() ? 1 : 0;
+    }
+
+    inline void fill_buffers()
+    {
+        for (auto &buffer : get_buffers())
+            buffer.fill();
+    }
+
+    // Times the variants of a kernel compiled from different schedules, one shared library per variant that exports
+    // symbol. The buffers get their initial values again before every variant and the report keys of the i-th
+    // variant start with "variant_<i>_", variants that could not be loaded or failed get a "variant_<i>_error".
+    template <typename Call>
+    int measure_variants(std::vector<std::string> libraries, std::string symbol, Call call)
+    {
+        Report report;
+        report.set("nb_variants", std::to_string(libraries.size()));
+        for (size_t i = 0; i < libraries.size(); i++)
+        {
+            std::string prefix = "variant_" + std::to_string(i) + "_";
+            // every variant keeps its own runtime, the libraries stay loaded until the wrapper exits
+            void *library = dlopen(libraries[i].c_str(), RTLD_NOW | RTLD_LOCAL);
+            void *kernel = library == nullptr ? nullptr : dlsym(library, symbol.c_str());
+            if (kernel == nullptr)
+            {
+                report.set(prefix + "error", "not_loaded");
+                continue;
+            }
+            auto shutdown_thread_pool = (void (*)())dlsym(library, "halide_shutdown_thread_pool");
+
+            fill_buffers();
+            int status = run_measurement([&]()
+                                         { return call(kernel); },
+                                         report, prefix, shutdown_thread_pool);
+            if (status != 0)
+                report.set(prefix + "error", "status_" + std::to_string(status));
+            if (shutdown_thread_pool)
+                shutdown_thread_pool();
+        }
+        report.write();
+        return 0;
+    }
+}
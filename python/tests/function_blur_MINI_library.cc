@@ -0,0 +1,27 @@
+#include <tiramisu/tiramisu.h>
+#include <TiraLibCPP/function_loader.h>
+
+using namespace tiramisu;
+
+// function_blur_MINI as generated by generate_code_no_grpc.py --shared-library
+extern "C" void build_function_blur_MINI(function_continuation continuation)
+{
+    std::string function_name = "function_blur_MINI";
+
+    tiramisu::init(function_name);
+
+    var xi("xi", 0, 34), yi("yi", 0, 18), ci("ci", 0, 5);
+    var x("x", 1, 34 - 1), y("y", 1, 18 - 1), c("c", 1, 5 - 1);
+
+    input input_img("input_img", {ci, yi, xi}, p_float64);
+
+    computation comp_blur("comp_blur", {c, y, x}, (input_img(c, y + 1, x - 1) + input_img(c, y + 1, x) + input_img(c, y + 1, x + 1) + input_img(c, y, x - 1) + input_img(c, y, x) + input_img(c, y, x + 1) + input_img(c, y - 1, x - 1) + input_img(c, y - 1, x) + input_img(c, y - 1, x + 1)) * 0.111111);
+
+    buffer input_buf("input_buf", {5, 18, 34}, p_float64, a_input);
+    buffer output_buf("output_buf", {5, 18, 34}, p_float64, a_output);
+
+    input_img.store_in(&input_buf);
+    comp_blur.store_in(&output_buf);
+
+    continuation({&input_buf, &output_buf});
+}
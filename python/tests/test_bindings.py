@@ -0,0 +1,56 @@
+import os
+import threading
+import unittest
+
+import tiralibcpp
+
+LIBRARY = os.environ["TIRALIBCPP_TEST_LIBRARY"]
+
+
+class BindingsTest(unittest.TestCase):
+    def setUp(self):
+        self.function = tiralibcpp.load_function(LIBRARY, "function_blur_MINI")
+
+    def test_legality(self):
+        result = self.function.schedule_str_to_result("P(L0,comps=['comp_blur'])")
+        self.assertEqual(result.name, "function_blur_MINI")
+        self.assertTrue(result.legality)
+
+    def test_evaluate_batch(self):
+        schedules = ["P(L0,comps=['comp_blur'])", "I(L0,L2,comps=['comp_blur'])", "R(L0,comps=['comp_blur'])"]
+        results = self.function.evaluate_batch(schedules)
+        self.assertEqual(len(results), 3)
+        # evaluations rebuild the function, so they match the ones made one by one
+        for schedule, result in zip(schedules, results):
+            self.assertEqual(result.legality, self.function.schedule_str_to_result(schedule).legality)
+
+    def test_annotations(self):
+        annotations = self.function.annotations()
+        self.assertIn("comp_blur", str(annotations))
+
+    def test_concurrent_calls(self):
+        # calls from several threads are serialized by the module, they must not interfere
+        results = [None] * 4
+
+        def evaluate(i):
+            results[i] = self.function.schedule_str_to_result("P(L0,comps=['comp_blur'])").legality
+
+        threads = [threading.Thread(target=evaluate, args=(i,)) for i in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(results, [True] * 4)
+
+    def test_canonicalize(self):
+        self.assertEqual(tiralibcpp.canonicalize_schedule_str("P( L0, comps=[ 'comp_blur' ] )"), "P(L0,comps=['comp_blur'])")
+
+    def test_result_fields(self):
+        result = self.function.schedule_str_to_result("")
+        self.assertEqual(len(result.exec_times), 0)
+        self.assertEqual(result.perf_counters, [])
+        self.assertEqual(result.problem_sizes, [])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,221 @@
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include <TiraLibCPP/actions.h>
+#include <TiraLibCPP/canonicalization.h>
+#include <TiraLibCPP/function_loader.h>
+#include <TiraLibCPP/search.h>
+
+#include <algorithm>
+#include <mutex>
+
+namespace py = pybind11;
+
+// Tiramisu keeps the function being scheduled in global state, so every call into the library holds this mutex and
+// calls from several Python threads run one at a time. The GIL is released while they run (and wait for the mutex) so
+// that the other Python threads keep running, but the evaluations themselves gain no concurrency: spread them over
+// processes (e.g. the work queue) for that.
+static std::mutex tiramisu_mutex;
+
+struct PyFunction
+{
+    std::string name;
+    function_builder builder;
+};
+
+static py::array_t<double> exec_times_to_array(const std::string &exec_times)
+{
+    std::vector<double> times = parse_exec_times(exec_times);
+    py::array_t<double> array(times.size());
+    std::copy(times.begin(), times.end(), array.mutable_data());
+    return array;
+}
+
+static Result evaluate(PyFunction &function, std::string schedule_str, std::string operation)
+{
+    Operation op = get_operation_from_string(operation);
+    py::gil_scoped_release release;
+    std::lock_guard<std::mutex> lock(tiramisu_mutex);
+    return builder_schedule_str_to_result(function.name, function.builder, schedule_str, op);
+}
+
+PYBIND11_MODULE(tiralibcpp, m)
+{
+    m.doc() = "In-process bindings of TiraLibCPP";
+
+    py::class_<Result>(m, "Result")
+        .def_readonly("name", &Result::name)
+        .def_readonly("legality", &Result::legality)
+        .def_readonly("isl_ast", &Result::isl_ast)
+        .def_readonly("additional_info", &Result::additional_info)
+        .def_readonly("success", &Result::success)
+        .def_readonly("predicted_speedup", &Result::predicted_speedup)
+        .def_property_readonly("skewing_candidates", [](const Result &result)
+                               { return py::module_::import("json").attr("loads")(result.skewing_candidates); })
+        .def_property_readonly("perf_counters", [](const Result &result)
+                               { return py::module_::import("json").attr("loads")(result.perf_counters); })
+        .def_readonly("measurement_slot", &Result::measurement_slot)
+        .def_readonly("cache_mode", &Result::cache_mode)
+        .def_readonly("allocation", &Result::allocation)
+        .def_readonly("validated", &Result::validated)
+        .def_readonly("validation_passed", &Result::validation_passed)
+        .def_readonly("validation_max_abs_error", &Result::validation_max_abs_error)
+        .def_readonly("validation_max_rel_error", &Result::validation_max_rel_error)
+        .def_readonly("output_checksum", &Result::output_checksum)
+        .def_readonly("flops", &Result::flops)
+        .def_readonly("compulsory_bytes", &Result::compulsory_bytes)
+        .def_readonly("arithmetic_intensity", &Result::arithmetic_intensity)
+        .def_readonly("achieved_gflops", &Result::achieved_gflops)
+        .def_readonly("achieved_bandwidth", &Result::achieved_bandwidth)
+        .def_readonly("peak_gflops", &Result::peak_gflops)
+        .def_readonly("peak_bandwidth", &Result::peak_bandwidth)
+        .def_property_readonly("operation_counts", [](const Result &result)
+                               { return py::module_::import("json").attr("loads")(result.operation_counts); })
+        .def_readonly("max_rss_kb", &Result::max_rss_kb)
+        .def_readonly("minor_page_faults", &Result::minor_page_faults)
+        .def_readonly("major_page_faults", &Result::major_page_faults)
+        .def_readonly("voluntary_context_switches", &Result::voluntary_context_switches)
+        .def_readonly("involuntary_context_switches", &Result::involuntary_context_switches)
+        .def_readonly("user_time", &Result::user_time)
+        .def_readonly("system_time", &Result::system_time)
+        .def_property_readonly("thread_sweep", [](const Result &result)
+                               { return py::module_::import("json").attr("loads")(result.thread_sweep); })
+        .def_property_readonly("problem_sizes", [](const Result &result)
+                               { return py::module_::import("json").attr("loads")(result.problem_sizes); })
+        .def_property_readonly("exec_times", [](const Result &result)
+                               { return exec_times_to_array(result.exec_times); })
+        .def("__repr__", [](Result &result)
+             { return serialize_result(result); });
+
+    py::class_<ActionMenu>(m, "ActionMenu")
+        .def(py::init<>())
+        .def_readwrite("parallelization", &ActionMenu::parallelization)
+        .def_readwrite("unrolling_factors", &ActionMenu::unrolling_factors)
+        .def_readwrite("vectorization_widths", &ActionMenu::vectorization_widths)
+        .def_readwrite("tiling_factors", &ActionMenu::tiling_factors)
+        .def_readwrite("interchange", &ActionMenu::interchange)
+        .def_readwrite("reversal", &ActionMenu::reversal)
+        .def_readwrite("skewing", &ActionMenu::skewing)
+        .def_readwrite("fusion", &ActionMenu::fusion);
+
+    py::class_<PyFunction>(m, "Function")
+        .def_readonly("name", &PyFunction::name)
+        .def("schedule_str_to_result", &evaluate, py::arg("schedule_str"), py::arg("operation") = "legality")
+        .def(
+            "evaluate_batch", [](PyFunction &function, std::vector<std::string> schedule_strs, std::string operation)
+            {
+                Operation op = get_operation_from_string(operation);
+                std::vector<Result> results;
+                py::gil_scoped_release release;
+                std::lock_guard<std::mutex> lock(tiramisu_mutex);
+                if (op == Operation::prediction)
+                    return builder_schedule_strs_to_predictions(function.name, function.builder, schedule_strs);
+                for (auto &schedule_str : schedule_strs)
+                    results.push_back(builder_schedule_str_to_result(function.name, function.builder, schedule_str, op));
+                return results; },
+            py::arg("schedule_strs"), py::arg("operation") = "legality")
+        .def(
+            "search", [](PyFunction &function, std::string method, int max_depth, int beam_size, int mcts_iterations,
+                         double time_budget, int max_executions, uint64_t seed, int nb_results, py::object cost)
+            {
+                SearchConfig config;
+                config.method = method;
+                config.max_depth = max_depth;
+                config.beam_size = beam_size;
+                config.mcts_iterations = mcts_iterations;
+                config.time_budget = time_budget;
+                config.max_executions = max_executions;
+                config.seed = seed;
+                config.nb_results = nb_results;
+
+                // a Python cost is called with the schedule and returns its cost, lower is better
+                cost_function cost_fn = nullptr;
+                if (py::isinstance<py::str>(cost))
+                {
+                    std::string cost_name = cost.cast<std::string>();
+                    if (cost_name == "prediction")
+                        cost_fn = make_prediction_cost(function.name, function.builder);
+                    else if (cost_name != "execution")
+                        throw std::invalid_argument("Unknown cost " + cost_name);
+                }
+                else if (!cost.is_none())
+                {
+                    // only legal schedules are evaluated
+                    cost_fn = [&cost, &function](std::string schedule_str, Result &result)
+                    {
+                        result = {.name = function.name, .legality = true, .success = true};
+                        py::gil_scoped_acquire acquire;
+                        return cost(schedule_str).cast<double>();
+                    };
+                }
+
+                std::vector<std::tuple<std::string, Result, double>> results;
+                py::gil_scoped_release release;
+                std::lock_guard<std::mutex> lock(tiramisu_mutex);
+                for (auto &search_result : search_schedules(function.name, function.builder, config, cost_fn))
+                    results.push_back({search_result.schedule_str, search_result.result, search_result.cost});
+                return results; },
+            py::arg("method") = "beam", py::arg("max_depth") = 4, py::arg("beam_size") = 4, py::arg("mcts_iterations") = 100,
+            py::arg("time_budget") = 0.0, py::arg("max_executions") = 0, py::arg("seed") = 0, py::arg("nb_results") = 5,
+            py::arg("cost") = py::none())
+        .def(
+            "sweep", [](PyFunction &function, std::string schedule_template, std::map<std::string, std::vector<int>> parameters,
+                        std::string method, int max_rounds, int compile_jobs)
+            {
+                ParameterSweepConfig config;
+                config.parameters = parameters;
+                config.method = method;
+                config.max_rounds = max_rounds;
+                config.compile_jobs = compile_jobs;
+
+                ParameterSweepResult sweep;
+                {
+                    py::gil_scoped_release release;
+                    std::lock_guard<std::mutex> lock(tiramisu_mutex);
+                    sweep = sweep_schedule_parameters(function.name, function.builder, schedule_template, config);
+                }
+                py::list points;
+                for (auto &point : sweep.points)
+                {
+                    py::dict point_dict;
+                    point_dict["values"] = point.values;
+                    point_dict["schedule_str"] = point.schedule_str;
+                    point_dict["legality"] = point.legality;
+                    point_dict["exec_times"] = point.exec_times;
+                    point_dict["median"] = point.median;
+                    points.append(point_dict);
+                }
+                return py::make_tuple(points, sweep.best); },
+            py::arg("schedule_template"), py::arg("parameters"), py::arg("method") = "grid", py::arg("max_rounds") = 4,
+            py::arg("compile_jobs") = 0)
+        .def(
+            "legal_actions", [](PyFunction &function, std::string prefix, ActionMenu menu)
+            {
+                ActionMask mask;
+                {
+                    py::gil_scoped_release release;
+                    std::lock_guard<std::mutex> lock(tiramisu_mutex);
+                    mask = get_legal_actions_mask(function.name, function.builder, prefix, menu);
+                }
+                py::array_t<bool> legal(mask.legal.size());
+                std::copy(mask.legal.begin(), mask.legal.end(), legal.mutable_data());
+                return py::make_tuple(mask.actions, legal); },
+            py::arg("prefix") = "", py::arg("menu") = ActionMenu())
+        .def("annotations", [](PyFunction &function)
+             {
+                std::string annotations;
+                {
+                    py::gil_scoped_release release;
+                    std::lock_guard<std::mutex> lock(tiramisu_mutex);
+                    annotations = builder_get_program_annotations(function.builder);
+                }
+                return py::module_::import("json").attr("loads")(annotations); });
+
+    m.def(
+        "load_function", [](std::string library_path, std::string function_name)
+        { return PyFunction{function_name, load_function_builder(library_path, function_name)}; },
+        py::arg("library_path"), py::arg("function_name"));
+
+    m.def("canonicalize_schedule_str", &canonicalize_schedule_str, py::arg("schedule_str"));
+}
@@ -0,0 +1,276 @@
+#include <tiramisu/tiramisu.h>
+#include <TiraLibCPP/action_space.h>
+#include <TiraLibCPP/actions.h>
+#include <TiraLibCPP/canonicalization.h>
+#include <TiraLibCPP/dependency_snapshot.h>
+
+#include <algorithm>
+#include <map>
+
+// value of a static (ordering) dimension of the schedule, -1 if it is not fixed
+static int get_static_dimension_value(tiramisu::computation *comp, int level)
+{
+    int dim = tiramisu::loop_level_into_static_dimension(level);
+    if (dim >= (int)isl_map_dim(comp->get_schedule(), isl_dim_out))
+        return -1;
+    isl_val *value = isl_map_plain_get_val_if_fixed(comp->get_schedule(), isl_dim_out, dim);
+    int static_value = (value != nullptr && isl_val_is_int(value)) ? isl_val_get_num_si(value) : -1;
+    isl_val_free(value);
+    return static_value;
+}
+
+std::vector<std::vector<tiramisu::computation *>> get_loop_nests(tiramisu::function *implicit_function)
+{
+    std::vector<std::pair<int, tiramisu::computation *>> ordered_comps;
+    for (auto comp : implicit_function->get_computations())
+    {
+        // inputs have no expression and are never scheduled
+        if (comp->get_expr().get_expr_type() == tiramisu::e_none || comp->get_loop_levels_number() == 0)
+            continue;
+        ordered_comps.push_back({get_static_dimension_value(comp, 0), comp});
+    }
+    std::stable_sort(ordered_comps.begin(), ordered_comps.end(), [](const auto &a, const auto &b)
+                     { return a.first < b.first; });
+
+    std::vector<std::vector<tiramisu::computation *>> loop_nests;
+    for (size_t i = 0; i < ordered_comps.size(); i++)
+    {
+        if (i == 0 || ordered_comps[i].first != ordered_comps[i - 1].first || ordered_comps[i].first == -1)
+            loop_nests.push_back({});
+        loop_nests.back().push_back(ordered_comps[i].second);
+    }
+    return loop_nests;
+}
+
+int get_shared_depth(std::vector<tiramisu::computation *> &loop_nest)
+{
+    int depth = loop_nest[0]->get_loop_levels_number();
+    for (auto comp : loop_nest)
+        depth = std::min(depth, comp->get_loop_levels_number());
+
+    // a level is shared while every ordering dimension above it is the same for all computations
+    for (int level = 1; level < depth; level++)
+    {
+        int static_value = get_static_dimension_value(loop_nest[0], level);
+        for (auto comp : loop_nest)
+        {
+            if (static_value == -1 || get_static_dimension_value(comp, level) != static_value)
+                return level;
+        }
+    }
+    return depth;
+}
+
+static std::string make_action(std::string name, std::vector<std::string> args, std::vector<tiramisu::computation *> comps)
+{
+    ParsedAction action;
+    action.name = name;
+    action.args = args;
+    for (auto comp : comps)
+        action.comps.push_back(comp->get_name());
+    return action_to_str(action);
+}
+
+static std::string level_str(int level)
+{
+    return "L" + std::to_string(level);
+}
+
+std::vector<std::string> get_candidate_actions(tiramisu::function *implicit_function, const ActionMenu &menu)
+{
+    std::vector<std::string> candidates;
+    auto loop_nests = get_loop_nests(implicit_function);
+    for (size_t nest = 0; nest < loop_nests.size(); nest++)
+    {
+        auto &comps = loop_nests[nest];
+        int depth = get_shared_depth(comps);
+        std::vector<int> extents;
+        for (int level = 0; level < depth; level++)
+            extents.push_back(get_loop_extent(comps[0], level));
+
+        for (int level = 0; level < depth; level++)
+        {
+            if (menu.parallelization)
+                candidates.push_back(make_action("P", {level_str(level)}, comps));
+            if (menu.reversal)
+                candidates.push_back(make_action("R", {level_str(level)}, comps));
+            for (int inner = level + 1; menu.interchange && inner < depth; inner++)
+                candidates.push_back(make_action("I", {level_str(level), level_str(inner)}, comps));
+            if (menu.skewing && level + 1 < depth)
+                candidates.push_back(make_action("S", {level_str(level), level_str(level + 1), "0", "0"}, comps));
+
+            // tiles have to be smaller than the loops they split (non-constant extents are always tiled)
+            for (auto factor1 : menu.tiling_factors)
+            {
+                for (auto factor2 : menu.tiling_factors)
+                {
+                    if (level + 1 >= depth || (extents[level] != -1 && extents[level] <= factor1) || (extents[level + 1] != -1 && extents[level + 1] <= factor2))
+                        continue;
+                    candidates.push_back(make_action("T2", {level_str(level), level_str(level + 1), std::to_string(factor1), std::to_string(factor2)}, comps));
+                }
+            }
+        }
+
+        // unrolling and vectorization apply to the innermost loop of a computation
+        if (comps.size() == 1)
+        {
+            int innermost = comps[0]->get_loop_levels_number() - 1;
+            int extent = get_loop_extent(comps[0], innermost);
+            for (auto factor : menu.unrolling_factors)
+            {
+                if (extent == -1 || extent >= factor)
+                    candidates.push_back(make_action("U", {level_str(innermost), std::to_string(factor)}, comps));
+            }
+            for (auto width : menu.vectorization_widths)
+            {
+                if (extent == -1 || extent >= width)
+                    candidates.push_back(make_action("V", {level_str(innermost), std::to_string(width)}, comps));
+            }
+        }
+
+        // the first computation of the next nest joins the loops of the last computation of this one
+        if (menu.fusion && nest + 1 < loop_nests.size())
+        {
+            auto last = comps.back();
+            auto next = loop_nests[nest + 1].front();
+            int fusion_depth = std::min(last->get_loop_levels_number(), next->get_loop_levels_number());
+            for (int level = 0; level < fusion_depth; level++)
+                candidates.push_back(make_action("F", {level_str(level)}, {last, next}));
+        }
+    }
+    return candidates;
+}
+
+// Actions that only modify the schedules of their computations, so restoring the schedules undoes them
+static bool is_undone_by_schedule_restore(ParsedAction &action)
+{
+    if (action.name == "F" || action.name == "Distribute" || action.name == "CA" || action.name == "Layout")
+        return false;
+    // tiling several computations also updates the levels at which they are ordered
+    if (action.name[0] == 'T' && action.comps.size() > 1)
+        return false;
+    for (auto &arg : action.args)
+    {
+        if (arg.rfind("parallel=", 0) == 0 && arg != "parallel=0" && arg != "parallel=False" && arg != "parallel=false")
+            return false;
+    }
+    return true;
+}
+
+// P, U and V only tag a loop of the current schedules, their legality is checked in place without applying the tag
+// (the function keeps the tags outside of the schedules, restoring the schedules would not undo them)
+static bool is_loop_tag_action(ParsedAction &action)
+{
+    return action.name == "P" || action.name == "U" || action.name == "V";
+}
+
+static bool is_loop_tag_legal(ParsedAction &action, tiramisu::function *implicit_function)
+{
+    int level = std::stoi(action.args[0].substr(1));
+    std::string comps_str;
+    for (auto &comp_name : action.comps)
+        comps_str += (comps_str.empty() ? "" : ",") + comp_name;
+    auto comps = get_comps(comps_str, implicit_function);
+
+    tiramisu::prepare_schedules_for_legality_checks(true);
+    if (action.name == "P")
+        return tiramisu::loop_parallelization_is_legal(level, comps);
+    if (action.name == "U")
+        return loop_unrolling_is_legal(level, comps);
+    return tiramisu::loop_vectorization_is_legal(level, comps);
+}
+
+ActionMask get_legal_actions_mask(std::string function_name, function_builder builder, std::string prefix, const ActionMenu &menu)
+{
+    ActionMask mask;
+    bool prefix_legal = true;
+    std::vector<size_t> rebuilt_actions;
+
+    builder([&](std::vector<tiramisu::buffer *> buffers)
+            {
+                auto implicit_function = tiramisu::global::get_implicit_function();
+                perform_dependency_analysis_with_snapshot(function_name, implicit_function);
+                Result result;
+                if (!prefix.empty())
+                    prefix_legal = apply_actions_from_schedule_str(prefix, implicit_function, result);
+                tiramisu::prepare_schedules_for_legality_checks(true);
+
+                mask.actions = get_candidate_actions(implicit_function, menu);
+                mask.legal.assign(mask.actions.size(), false);
+                if (!prefix_legal)
+                    return;
+
+                // the tags do not change the schedules, the whole function is checked once for all of them
+                bool schedules_legal = false;
+                try
+                {
+                    tiramisu::prepare_schedules_for_legality_checks();
+                    schedules_legal = check_legality_of_scheduled_function(implicit_function);
+                }
+                catch (std::exception &e)
+                {
+                    schedules_legal = false;
+                }
+
+                std::map<std::string, std::string> schedules;
+                for (auto comp : implicit_function->get_computations())
+                {
+                    char *schedule_str = isl_map_to_str(comp->get_schedule());
+                    schedules[comp->get_name()] = schedule_str;
+                    free(schedule_str);
+                }
+
+                for (size_t i = 0; i < mask.actions.size(); i++)
+                {
+                    auto action = parse_action_str(mask.actions[i]);
+                    if (is_loop_tag_action(action))
+                    {
+                        try
+                        {
+                            mask.legal[i] = schedules_legal && is_loop_tag_legal(action, implicit_function);
+                        }
+                        catch (std::exception &e)
+                        {
+                            mask.legal[i] = false;
+                        }
+                        continue;
+                    }
+                    if (!is_undone_by_schedule_restore(action))
+                    {
+                        rebuilt_actions.push_back(i);
+                        continue;
+                    }
+
+                    try
+                    {
+                        Result candidate_result;
+                        bool is_legal = apply_action(mask.actions[i], implicit_function, candidate_result);
+                        tiramisu::prepare_schedules_for_legality_checks();
+                        is_legal &= check_legality_of_scheduled_function(implicit_function);
+                        mask.legal[i] = is_legal;
+                    }
+                    catch (std::exception &e)
+                    {
+                        mask.legal[i] = false;
+                    }
+
+                    for (auto comp : implicit_function->get_computations())
+                    {
+                        comp->set_schedule(isl_map_read_from_str(implicit_function->get_isl_ctx(), schedules[comp->get_name()].c_str()));
+                    }
+                } });
+
+    for (auto i : rebuilt_actions)
+    {
+        std::string schedule_str = prefix.empty() ? mask.actions[i] : prefix + "|" + mask.actions[i];
+        try
+        {
+            mask.legal[i] = builder_schedule_str_to_result(function_name, builder, schedule_str, Operation::legality).legality;
+        }
+        catch (std::exception &e)
+        {
+            mask.legal[i] = false;
+        }
+    }
+    return mask;
+}
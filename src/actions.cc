@@ -1,8 +1,523 @@
 #include <tiramisu/tiramisu.h>
 #include <string>
 #include <regex>
+#include <set>
+#include <map>
+#include <TiraLibCPP/actions.h>
 #include <TiraLibCPP/utils.h>
-#include <TiraLibCPP/dbhelpers.h>
+#include <TiraLibCPP/dependency_snapshot.h>
+#include <TiraLibCPP/execution.h>
+#include <TiraLibCPP/canonicalization.h>
+#include <TiraLibCPP/skewing_solver.h>
+#include <climits>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// parses "[L0,L1]" or "[32,32]" into {0, 1} or {32, 32}
+static std::vector<int> parse_int_list(std::string list_str)
+{
+    list_str.erase(std::remove_if(list_str.begin(), list_str.end(), [](char c)
+                                  { return c == '[' || c == ']' || c == 'L' || std::isspace(c); }),
+                   list_str.end());
+    std::vector<int> values;
+    std::stringstream ss(list_str);
+    std::string token;
+    while (std::getline(ss, token, ','))
+    {
+        if (!token.empty())
+            values.push_back(std::stoi(token));
+    }
+    return values;
+}
+
+// Tiles the consecutive levels [base, base + depth) of a computation, Tiramisu only provides tile() up to 3 levels
+static void tile_band(tiramisu::computation *comp, int base, std::vector<int> factors)
+{
+    int depth = factors.size();
+    if (depth == 1)
+    {
+        comp->tile(base, factors[0]);
+    }
+    else if (depth == 2)
+    {
+        comp->tile(base, base + 1, factors[0], factors[1]);
+    }
+    else if (depth == 3)
+    {
+        comp->tile(base, base + 1, base + 2, factors[0], factors[1], factors[2]);
+    }
+    else
+    {
+        // split from the innermost level so that the outer levels keep their numbers,
+        // the band is then o0 i0 o1 i1 ... and every outer loop is moved in front of the inner loops
+        for (int k = depth - 1; k >= 0; k--)
+        {
+            comp->split(base + k, factors[k]);
+        }
+        for (int k = 1; k < depth; k++)
+        {
+            for (int pos = base + 2 * k; pos > base + k; pos--)
+            {
+                comp->interchange(pos - 1, pos);
+            }
+        }
+    }
+}
+
+// Tiles the given levels with one band of factors per tiling level: factors = [outer band..., inner band...]
+static bool apply_tiling(std::vector<int> levels, std::vector<int> factors, std::vector<tiramisu::computation *> comps, tiramisu::function *implicit_function, bool parallel, bool check_legality)
+{
+    int depth = levels.size();
+    if (depth == 0 || comps.empty())
+        throw std::invalid_argument("Tiling needs at least one level and one computation");
+    if (factors.size() == 0 || factors.size() % depth != 0)
+        throw std::invalid_argument("Tiling needs the same number of factors for every level");
+    for (int i = 1; i < depth; i++)
+    {
+        if (levels[i] != levels[i - 1] + 1)
+            throw std::invalid_argument("Tiling only supports consecutive levels");
+    }
+    for (auto factor : factors)
+    {
+        if (factor <= 0)
+            throw std::invalid_argument("Tiling factors must be positive");
+    }
+
+    // the inner loops of a band are tiled again by the next band (e.g. L2 then L1 tiles)
+    int nb_bands = factors.size() / depth;
+    for (int band = 0; band < nb_bands; band++)
+    {
+        int base = levels[0] + band * depth;
+        std::vector<int> band_factors(factors.begin() + band * depth, factors.begin() + (band + 1) * depth);
+        for (auto comp : comps)
+        {
+            tile_band(comp, base, band_factors);
+        }
+        if (comps.size() > 1)
+            implicit_function->fuse_comps_after_tiling(comps, depth);
+    }
+
+    bool is_legal = true;
+    if (check_legality)
+    {
+        tiramisu::prepare_schedules_for_legality_checks(true);
+        is_legal = implicit_function->check_partial_legality_in_function(comps);
+    }
+    if (parallel)
+    {
+        tiramisu::prepare_schedules_for_legality_checks(true);
+        is_legal &= tiramisu::loop_parallelization_is_legal(levels[0], comps);
+        // computations that are not fused with the others have their own outer tile loop
+        for (auto comp : comps)
+            comp->tag_parallel_level(levels[0]);
+    }
+    return is_legal;
+}
+
+// accesses of comp to the computation named target (maps from the domain of comp to the domain of target)
+static std::vector<isl_map *> get_accesses_to(tiramisu::computation *comp, std::string target, tiramisu::function *implicit_function)
+{
+    std::vector<isl_map *> accesses;
+    tiramisu::generator::get_rhs_accesses(implicit_function, comp, accesses, false);
+
+    std::vector<isl_map *> target_accesses;
+    for (auto access : accesses)
+    {
+        const char *name = isl_map_get_tuple_name(access, isl_dim_out);
+        if (name != nullptr && target == name)
+            target_accesses.push_back(access);
+        else
+            isl_map_free(access);
+    }
+    return target_accesses;
+}
+
+// Extent of every dimension of the producer elements read by one iteration of the consumer loops [0, level],
+// -1 for the dimensions whose extent is not a constant
+static std::vector<int> get_compute_at_footprint(tiramisu::computation *producer, tiramisu::computation *consumer, int level, std::vector<isl_map *> accesses)
+{
+    isl_map *consumer_to_producer = accesses[0];
+    for (size_t i = 1; i < accesses.size(); i++)
+        consumer_to_producer = isl_map_union(consumer_to_producer, accesses[i]);
+
+    // keep the time dimensions up to the loop level
+    isl_map *outer = isl_map_intersect_domain(isl_map_copy(consumer->get_schedule()), isl_set_copy(consumer->get_iteration_domain()));
+    int last_dim = tiramisu::loop_level_into_dynamic_dimension(level);
+    int n_out = isl_map_dim(outer, isl_dim_out);
+    outer = isl_map_project_out(outer, isl_dim_out, last_dim + 1, n_out - last_dim - 1);
+
+    // outer iteration -> producer elements it reads, then the distance between two elements read by the same iteration
+    isl_map *footprint = isl_map_apply_range(isl_map_reverse(outer), consumer_to_producer);
+    isl_map *pairs = isl_map_apply_range(isl_map_reverse(isl_map_copy(footprint)), footprint);
+    isl_set *deltas = isl_map_deltas(pairs);
+
+    std::vector<int> extents;
+    int n_dims = isl_set_dim(producer->get_iteration_domain(), isl_dim_set);
+    for (int dim = 0; dim < n_dims; dim++)
+    {
+        isl_val *max = isl_set_dim_max_val(isl_set_copy(deltas), dim);
+        extents.push_back(isl_val_is_int(max) ? isl_val_get_num_si(max) + 1 : -1);
+        isl_val_free(max);
+    }
+    isl_set_free(deltas);
+    return extents;
+}
+
+// Producers moved by compute_at in the functions being scheduled, with their consumers. apply_compute_at checks the
+// dependences between the two itself, the legality check of the whole function leaves them out because compute_at
+// adds redundant iterations to the producer's domain, which the dependences computed on the original domains do not
+// describe.
+static std::map<tiramisu::function *, std::vector<std::pair<std::string, std::string>>> computed_at_producers;
+
+// Replaces the dependences of the producer in deps: the ones with the consumer are dropped, the ones from the other
+// computations into the producer go to the consumer iterations that read it (producer_to_consumer).
+static isl_union_map *redirect_producer_dependences(isl_union_map *deps, isl_union_set *producer_domain, isl_union_set *consumer_domain, isl_union_map *producer_to_consumer)
+{
+    isl_union_map *into_producer = isl_union_map_intersect_range(isl_union_map_copy(deps), isl_union_set_copy(producer_domain));
+    into_producer = isl_union_map_subtract_domain(into_producer, isl_union_set_union(isl_union_set_copy(producer_domain), isl_union_set_copy(consumer_domain)));
+    isl_union_map *redirected = isl_union_map_apply_range(into_producer, isl_union_map_copy(producer_to_consumer));
+
+    deps = isl_union_map_subtract_domain(deps, isl_union_set_copy(producer_domain));
+    deps = isl_union_map_subtract_range(deps, isl_union_set_copy(producer_domain));
+    return isl_union_map_union(deps, redirected);
+}
+
+bool check_legality_of_scheduled_function(tiramisu::function *implicit_function)
+{
+    auto producers = computed_at_producers.find(implicit_function);
+    if (producers == computed_at_producers.end() || producers->second.empty())
+        return tiramisu::check_legality_of_function();
+
+    // the dependences of the function are only changed for this check, the other actions keep seeing all of them
+    isl_union_map *raw = isl_union_map_copy(implicit_function->get_dep_read_after_write());
+    isl_union_map *waw = isl_union_map_copy(implicit_function->get_dep_write_after_write());
+    isl_union_map *war = isl_union_map_copy(implicit_function->get_dep_write_after_read());
+    isl_union_map *checked_raw = isl_union_map_copy(raw);
+    isl_union_map *checked_waw = isl_union_map_copy(waw);
+    isl_union_map *checked_war = isl_union_map_copy(war);
+    for (auto &producer_consumer : producers->second)
+    {
+        auto producer = get_computation_by_name(producer_consumer.first, implicit_function);
+        auto consumer = get_computation_by_name(producer_consumer.second, implicit_function);
+        isl_union_set *producer_domain = isl_union_set_from_set(isl_set_universe(isl_set_get_space(producer->get_iteration_domain())));
+        isl_union_set *consumer_domain = isl_union_set_from_set(isl_set_universe(isl_set_get_space(consumer->get_iteration_domain())));
+
+        // the accesses of the consumer map its iterations to the producer iterations it reads
+        isl_union_map *consumer_to_producer = nullptr;
+        for (auto access : get_accesses_to(consumer, producer->get_name(), implicit_function))
+        {
+            isl_union_map *union_access = isl_union_map_from_map(access);
+            consumer_to_producer = consumer_to_producer == nullptr ? union_access : isl_union_map_union(consumer_to_producer, union_access);
+        }
+        isl_union_map *producer_to_consumer = isl_union_map_reverse(consumer_to_producer);
+
+        checked_raw = redirect_producer_dependences(checked_raw, producer_domain, consumer_domain, producer_to_consumer);
+        checked_waw = redirect_producer_dependences(checked_waw, producer_domain, consumer_domain, producer_to_consumer);
+        checked_war = redirect_producer_dependences(checked_war, producer_domain, consumer_domain, producer_to_consumer);
+        isl_union_set_free(producer_domain);
+        isl_union_set_free(consumer_domain);
+        isl_union_map_free(producer_to_consumer);
+    }
+    implicit_function->set_dep_read_after_write(checked_raw);
+    implicit_function->set_dep_write_after_write(checked_waw);
+    implicit_function->set_dep_write_after_read(checked_war);
+
+    bool is_legal = tiramisu::check_legality_of_function();
+
+    implicit_function->set_dep_read_after_write(raw);
+    implicit_function->set_dep_write_after_write(waw);
+    implicit_function->set_dep_write_after_read(war);
+    return is_legal;
+}
+
+// Computes the producer at the loop level of its consumer. When the producer stores in a temporary buffer,
+// it is stored in a buffer allocated at that level that only holds the elements read by one iteration.
+static bool apply_compute_at(tiramisu::computation *producer, tiramisu::computation *consumer, int level, tiramisu::function *implicit_function, Result &result)
+{
+    if (producer == consumer)
+        throw std::invalid_argument("compute_at needs two different computations");
+    if (level < 0 || level >= consumer->get_loop_levels_number())
+        throw std::invalid_argument("compute_at level is out of the loop nest of " + consumer->get_name());
+
+    auto accesses = get_accesses_to(consumer, producer->get_name(), implicit_function);
+    if (accesses.empty())
+    {
+        append_additional_info(result, "compute_at_failed:" + producer->get_name());
+        return false;
+    }
+
+    // recomputing the producer is only safe when it reads values that stay the same while the consumer runs
+    // and when the consumer is the only computation that reads or writes its buffer
+    std::string buffer_name = isl_map_get_tuple_name(producer->get_access_relation(), isl_dim_out);
+    auto self_accesses = get_accesses_to(producer, producer->get_name(), implicit_function);
+    bool is_legal = self_accesses.empty();
+    for (auto access : self_accesses)
+        isl_map_free(access);
+    for (auto comp : implicit_function->get_computations())
+    {
+        if (comp == producer || comp == consumer)
+            continue;
+        auto comp_accesses = get_accesses_to(comp, producer->get_name(), implicit_function);
+        is_legal &= comp_accesses.empty();
+        for (auto access : comp_accesses)
+            isl_map_free(access);
+        if (comp->get_access_relation() != nullptr && buffer_name == isl_map_get_tuple_name(comp->get_access_relation(), isl_dim_out))
+            is_legal = false;
+    }
+    isl_union_set *producer_domain = isl_union_set_from_set(isl_set_universe(isl_set_get_space(producer->get_iteration_domain())));
+    isl_union_map *overwrites = isl_union_map_intersect_domain(isl_union_map_copy(implicit_function->get_dep_write_after_read()), isl_union_set_copy(producer_domain));
+    is_legal &= isl_union_map_is_empty(overwrites) == isl_bool_true;
+    isl_union_map_free(overwrites);
+
+    if (!is_legal)
+    {
+        for (auto access : accesses)
+            isl_map_free(access);
+        isl_union_set_free(producer_domain);
+        append_additional_info(result, "compute_at_failed:" + producer->get_name());
+        return false;
+    }
+
+    isl_union_set_free(producer_domain);
+    auto extents = get_compute_at_footprint(producer, consumer, level, accesses);
+
+    // the dependences of the producer were checked above, see check_legality_of_scheduled_function
+    computed_at_producers[implicit_function].push_back({producer->get_name(), consumer->get_name()});
+    producer->compute_at(*consumer, level);
+
+    tiramisu::buffer *producer_buffer = implicit_function->get_buffers().at(buffer_name);
+    bool reducible = producer_buffer->get_argument_type() == tiramisu::a_temporary &&
+                     std::find(extents.begin(), extents.end(), -1) == extents.end();
+    if (!reducible)
+    {
+        // outputs must keep every element, the producer is recomputed into its full buffer
+        append_additional_info(result, "compute_at_storage:full");
+        return true;
+    }
+
+    // element (i0, i1, ...) of the producer is stored at (i0 % e0, i1 % e1, ...), the elements read by one
+    // iteration of the consumer are less than e_k apart in every dimension so they never share a slot
+    std::vector<tiramisu::expr> sizes;
+    std::vector<tiramisu::expr> indices;
+    std::string sizes_str;
+    auto iterators = producer->get_iteration_variables();
+    for (size_t dim = 0; dim < extents.size(); dim++)
+    {
+        sizes.push_back(extents[dim]);
+        indices.push_back(iterators[dim] % extents[dim]);
+        sizes_str += (dim > 0 ? "x" : "") + std::to_string(extents[dim]);
+    }
+
+    auto local_buffer = new tiramisu::buffer("_" + producer->get_name() + "_local", sizes, producer->get_data_type(), tiramisu::a_temporary, implicit_function);
+    producer->store_in(local_buffer, indices);
+    tiramisu::computation *allocation = local_buffer->allocate_at(*consumer, level);
+    allocation->before(*producer, level);
+
+    append_additional_info(result, "compute_at_storage:" + local_buffer->get_name() + ":" + sizes_str);
+    return true;
+}
+
+// Bounds of the elements of buffer_name written by the computations of the function. Returns false when the
+// written elements do not form a box.
+static bool get_written_box(std::string buffer_name, int n_dims, tiramisu::function *implicit_function, std::vector<int> &min, std::vector<int> &max)
+{
+    isl_set *written = nullptr;
+    for (auto writer : implicit_function->get_computations())
+    {
+        if (writer->get_expr().get_expr_type() == tiramisu::e_none || writer->get_access_relation() == nullptr ||
+            buffer_name != isl_map_get_tuple_name(writer->get_access_relation(), isl_dim_out))
+            continue;
+        isl_set *elements = isl_set_apply(isl_set_copy(writer->get_iteration_domain()), isl_map_copy(writer->get_access_relation()));
+        written = written == nullptr ? elements : isl_set_union(written, elements);
+    }
+    if (written == nullptr)
+        return false;
+
+    bool bounded = true;
+    std::string box_str = "{" + buffer_name + "[";
+    std::string constraints_str;
+    for (int dim = 0; dim < n_dims; dim++)
+    {
+        isl_val *max_val = isl_set_dim_max_val(isl_set_copy(written), dim);
+        isl_val *min_val = isl_set_dim_min_val(isl_set_copy(written), dim);
+        bounded &= isl_val_is_int(max_val) == isl_bool_true && isl_val_is_int(min_val) == isl_bool_true;
+        if (bounded)
+        {
+            min.push_back(isl_val_get_num_si(min_val));
+            max.push_back(isl_val_get_num_si(max_val));
+        }
+        isl_val_free(max_val);
+        isl_val_free(min_val);
+        if (!bounded)
+            break;
+        std::string dim_str = "d" + std::to_string(dim);
+        box_str += (dim > 0 ? "," : "") + dim_str;
+        constraints_str += (dim > 0 ? " and " : "") + std::to_string(min[dim]) + "<=" + dim_str + "<=" + std::to_string(max[dim]);
+    }
+    if (!bounded)
+    {
+        isl_set_free(written);
+        return false;
+    }
+
+    box_str += "]:" + constraints_str + "}";
+    isl_set *box = isl_set_read_from_str(implicit_function->get_isl_ctx(), box_str.c_str());
+    bool is_box = isl_set_is_subset(box, written) == isl_bool_true;
+    isl_set_free(box);
+    isl_set_free(written);
+    return is_box;
+}
+
+// Time of the last iteration of comp in its current schedule, empty when it is not constant
+static std::vector<long> get_last_time(tiramisu::computation *comp)
+{
+    isl_set *time_space = isl_set_apply(isl_set_copy(comp->get_iteration_domain()), isl_map_copy(comp->get_schedule()));
+    isl_set *last = isl_set_lexmax(time_space);
+    std::vector<long> time;
+    int n_dims = isl_set_dim(last, isl_dim_set);
+    for (int dim = 0; dim < n_dims; dim++)
+    {
+        isl_val *value = isl_set_dim_max_val(isl_set_copy(last), dim);
+        bool is_int = isl_val_is_int(value) == isl_bool_true;
+        if (is_int)
+            time.push_back(isl_val_get_num_si(value));
+        isl_val_free(value);
+        if (!is_int)
+        {
+            time.clear();
+            break;
+        }
+    }
+    isl_set_free(last);
+    return time;
+}
+
+// Stores the buffer of comp with its dimensions permuted (new dimension k is old dimension permutation[k])
+// and the innermost dimension padded. Every computation stored in the buffer is remapped, the computations
+// that read them follow through their access relations. Output buffers keep their layout for the caller:
+// the computations write to a temporary buffer with the new layout and the elements they write are copied out at
+// the end, the others keep the values set by the caller.
+static bool apply_layout(tiramisu::computation *comp, std::vector<int> permutation, int padding, tiramisu::function *implicit_function, Result &result)
+{
+    std::string buffer_name = isl_map_get_tuple_name(comp->get_access_relation(), isl_dim_out);
+    tiramisu::buffer *old_buffer = implicit_function->get_buffers().at(buffer_name);
+    int n_dims = old_buffer->get_n_dims();
+
+    std::vector<int> sorted_permutation = permutation;
+    std::sort(sorted_permutation.begin(), sorted_permutation.end());
+    for (int dim = 0; dim < (int)sorted_permutation.size(); dim++)
+    {
+        if (sorted_permutation[dim] != dim || (int)permutation.size() != n_dims)
+            throw std::invalid_argument("The layout of " + buffer_name + " needs a permutation of its " + std::to_string(n_dims) + " dimensions");
+    }
+    if (padding < 0)
+        throw std::invalid_argument("Layout padding must be positive");
+
+    // the wrapper fills the inputs before calling the function, they cannot be moved to another buffer
+    if (old_buffer->get_argument_type() == tiramisu::a_input)
+    {
+        append_additional_info(result, "layout_failed:" + buffer_name);
+        return false;
+    }
+    // neither can the values set by the caller in an output that an input reads in place (icomp00 stored in buf00)
+    for (auto reader : implicit_function->get_computations())
+    {
+        if (old_buffer->get_argument_type() != tiramisu::a_temporary && reader->get_expr().get_expr_type() == tiramisu::e_none &&
+            reader->get_access_relation() != nullptr && buffer_name == isl_map_get_tuple_name(reader->get_access_relation(), isl_dim_out))
+        {
+            append_additional_info(result, "layout_failed:" + buffer_name);
+            return false;
+        }
+    }
+
+    std::vector<int> old_sizes;
+    for (auto &size : old_buffer->get_dim_sizes())
+    {
+        if (!size.is_constant())
+            throw std::invalid_argument("Layout needs the sizes of " + buffer_name + " to be constant");
+        old_sizes.push_back(size.get_int32_value());
+    }
+
+    // the copy out is a single loop nest over the written elements
+    std::vector<int> written_min, written_max;
+    if (old_buffer->get_argument_type() != tiramisu::a_temporary &&
+        !get_written_box(buffer_name, n_dims, implicit_function, written_min, written_max))
+    {
+        append_additional_info(result, "layout_failed:" + buffer_name);
+        return false;
+    }
+
+    std::string new_buffer_name = "_" + buffer_name + "_layout";
+    std::vector<tiramisu::expr> new_sizes;
+    std::string sizes_str;
+    std::string old_dims_str, new_dims_str;
+    for (int dim = 0; dim < n_dims; dim++)
+    {
+        int size = old_sizes[permutation[dim]] + (dim == n_dims - 1 ? padding : 0);
+        new_sizes.push_back(size);
+        sizes_str += (dim > 0 ? "x" : "") + std::to_string(size);
+        old_dims_str += (dim > 0 ? "," : "") + std::string("d") + std::to_string(dim);
+        new_dims_str += (dim > 0 ? "," : "") + std::string("d") + std::to_string(permutation[dim]);
+    }
+    auto new_buffer = new tiramisu::buffer(new_buffer_name, new_sizes, old_buffer->get_elements_type(), tiramisu::a_temporary, implicit_function);
+
+    std::string layout_map_str = "{" + buffer_name + "[" + old_dims_str + "]->" + new_buffer_name + "[" + new_dims_str + "]}";
+    isl_map *layout_map = isl_map_read_from_str(implicit_function->get_isl_ctx(), layout_map_str.c_str());
+
+    // the computations stored in the buffer are remapped, including the inputs that read a temporary buffer in place.
+    // The copy out runs after the computation that ends last in the current schedule, which is not the last one
+    // declared once actions like F, Distribute or CA have reordered the loop nests.
+    tiramisu::prepare_schedules_for_legality_checks(true);
+    tiramisu::computation *last_computation = nullptr;
+    std::vector<long> last_time;
+    for (auto comp_in_buffer : implicit_function->get_computations())
+    {
+        if (comp_in_buffer->get_expr().get_expr_type() != tiramisu::e_none)
+        {
+            auto time = get_last_time(comp_in_buffer);
+            if (last_computation == nullptr || time >= last_time)
+            {
+                last_computation = comp_in_buffer;
+                last_time = time;
+            }
+        }
+        if (comp_in_buffer->get_access_relation() == nullptr || buffer_name != isl_map_get_tuple_name(comp_in_buffer->get_access_relation(), isl_dim_out))
+            continue;
+        comp_in_buffer->set_access(isl_map_apply_range(isl_map_copy(comp_in_buffer->get_access_relation()), isl_map_copy(layout_map)));
+    }
+    isl_map_free(layout_map);
+
+    if (old_buffer->get_argument_type() == tiramisu::a_temporary)
+    {
+        old_buffer->set_auto_allocate(false);
+    }
+    else
+    {
+        // copy_out[d0,...] = layout_view[d_p0,...] into the output buffer, after every other computation
+        std::vector<tiramisu::var> old_vars, new_vars;
+        for (int dim = 0; dim < n_dims; dim++)
+        {
+            old_vars.push_back(tiramisu::var("_" + buffer_name + "_d" + std::to_string(dim), written_min[dim], written_max[dim] + 1));
+        }
+        std::vector<tiramisu::expr> view_indices;
+        for (int dim = 0; dim < n_dims; dim++)
+        {
+            new_vars.push_back(tiramisu::var("_" + buffer_name + "_n" + std::to_string(dim), 0, new_sizes[dim].get_int32_value()));
+            view_indices.push_back(old_vars[permutation[dim]]);
+        }
+
+        auto view = new tiramisu::input(new_buffer_name + "_view", new_vars, old_buffer->get_elements_type());
+        view->store_in(new_buffer);
+        auto copy_out = new tiramisu::computation("_" + buffer_name + "_copy_out", old_vars,
+                                                  tiramisu::expr(tiramisu::o_access, view->get_name(), view_indices, old_buffer->get_elements_type()));
+        copy_out->store_in(old_buffer);
+        copy_out->after(*last_computation, tiramisu::computation::root);
+    }
+
+    append_additional_info(result, "layout:" + new_buffer_name + ":" + sizes_str);
+    return true;
+}
 
 bool apply_action(std::string action_str, tiramisu::function *implicit_function, Result &result)
 {
@@ -47,6 +562,39 @@ bool apply_action(std::string action_str, tiramisu::function *implicit_function,
         }
         break;
     }
+    case 'V':
+    {
+        std::string regex_str = "V\\(L(\\d),(\\d+),comps=\\[([\\w', ]*)\\]\\)";
+        std::regex re(regex_str);
+        std::smatch match;
+        std::regex_search(action_str, match, re);
+        int level = std::stoi(match[1]);
+        int width = std::stoi(match[2]);
+        std::string comps_str = match[3];
+        comps_str.erase(std::remove_if(comps_str.begin(), comps_str.end(), isSingleQuoteOrWhiteSpace), comps_str.end());
+        auto comps = get_comps(comps_str, implicit_function);
+        if (width < 1)
+            throw std::invalid_argument("Vectorization width must be positive");
+
+        tiramisu::prepare_schedules_for_legality_checks(true);
+        is_legal = tiramisu::loop_vectorization_is_legal(level, comps);
+
+        // the vector cannot be wider than the loop and stays a power of two, the width is the largest power of two
+        // that fits in both (an extent of 33 gets 32 lanes, a width of 24 on an extent of 10 gets 8). Extents that
+        // are not a multiple of the width get a scalar epilogue from vectorize (it separates the full and partial tiles).
+        int extent = get_loop_extent(comps[0], level);
+        int max_width = extent > 0 ? std::min(width, extent) : width;
+        int effective_width = 1;
+        while (effective_width * 2 <= max_width)
+            effective_width *= 2;
+        append_additional_info(result, "vectorization_width:" + std::to_string(effective_width));
+
+        for (auto comp : comps)
+        {
+            comp->vectorize(tiramisu::var(comp->get_loop_level_names()[level]), effective_width);
+        }
+        break;
+    }
     case 'I':
     {
         std::string regex_str = "I\\(L(\\d),L(\\d),comps=\\[([\\w', ]*)\\]\\)";
@@ -82,6 +630,28 @@ bool apply_action(std::string action_str, tiramisu::function *implicit_function,
     }
     case 'S':
     {
+        if (action_str.rfind("Shift", 0) == 0)
+        {
+            // Shift(Lk,amount,comps=[...])
+            auto action = parse_action_str(action_str);
+            if (action.args.size() != 2 || action.comps.empty())
+                throw std::invalid_argument("Wrong shifting action " + action_str);
+            int level = parse_int_list(action.args[0])[0];
+            int amount = std::stoi(action.args[1]);
+
+            std::vector<tiramisu::computation *> comps;
+            for (auto &comp_name : action.comps)
+            {
+                auto comp = get_computation_by_name(comp_name, implicit_function);
+                comp->shift(tiramisu::var(comp->get_loop_level_names()[level]), amount);
+                comps.push_back(comp);
+            }
+
+            tiramisu::prepare_schedules_for_legality_checks(true);
+            is_legal = implicit_function->check_partial_legality_in_function(comps);
+            break;
+        }
+
         std::string regex_str = "S\\(L(\\d),L(\\d),(-?\\d+),(-?\\d+),comps=\\[([\\w', ]*)\\]\\)";
         std::regex re(regex_str);
         std::smatch match;
@@ -122,7 +692,7 @@ bool apply_action(std::string action_str, tiramisu::function *implicit_function,
         }
         if (is_legal)
         {
-            result.additional_info = "skewing_factors:" + std::to_string(factor1) + "," + std::to_string(factor2);
+            append_additional_info(result, "skewing_factors:" + std::to_string(factor1) + "," + std::to_string(factor2));
             for (auto comp : comps)
             {
                 comp->skew(level1, level2, factor1, factor2);
@@ -131,6 +701,28 @@ bool apply_action(std::string action_str, tiramisu::function *implicit_function,
 
         break;
     }
+    case 'D':
+    {
+        // Distribute(Lk,comps=[...]): the computations only share the loops above Lk, in the order they are given
+        auto action = parse_action_str(action_str);
+        if (action.name != "Distribute" || action.args.size() != 1 || action.comps.size() < 2)
+            throw std::invalid_argument("Distribution needs a level and at least two computations");
+        int level = parse_int_list(action.args[0])[0];
+
+        std::vector<tiramisu::computation *> comps;
+        for (auto &comp_name : action.comps)
+        {
+            comps.push_back(get_computation_by_name(comp_name, implicit_function));
+        }
+        for (size_t i = 1; i < comps.size(); i++)
+        {
+            comps[i]->after(*comps[i - 1], level - 1);
+        }
+
+        tiramisu::prepare_schedules_for_legality_checks(true);
+        is_legal = implicit_function->check_partial_legality_in_function(comps);
+        break;
+    }
     case 'F':
     {
         std::string regex_str = "F\\(L(\\d),comps=\\[([\\w', ]*)\\]\\)";
@@ -141,99 +733,93 @@ bool apply_action(std::string action_str, tiramisu::function *implicit_function,
         std::string comps_str = match[2];
         comps_str.erase(std::remove_if(comps_str.begin(), comps_str.end(), isSingleQuoteOrWhiteSpace), comps_str.end());
         auto comps = get_comps(comps_str, implicit_function);
-        // only accept fusion of two computations
-        assert(comps.size() == 2);
-        implicit_function->fuse_comps_sched_graph(comps[0], comps[1], level);
+        if (comps.size() < 2)
+        {
+            throw std::invalid_argument("Fusion needs at least two computations");
+        }
 
-        tiramisu::prepare_schedules_for_legality_checks(true);
         std::vector<int> levels = {};
         for (int i = 0; i <= level; i++)
         {
             levels.push_back(i);
         }
-        std::vector<std::tuple<tiramisu::var, int>> factors = tiramisu::global::get_implicit_function()->correcting_loop_fusion_with_shifting({comps[0]}, *comps[1], levels);
-        for (const auto &tuple : factors)
+
+        // fuse the computations in order, each one is shifted against all the computations fused before it
+        for (size_t i = 1; i < comps.size(); i++)
         {
-            tiramisu::var var = std::get<0>(tuple);
-            int value = std::get<1>(tuple);
+            implicit_function->fuse_comps_sched_graph(comps[i - 1], comps[i], level);
+
+            tiramisu::prepare_schedules_for_legality_checks(true);
+            std::vector<tiramisu::computation *> predecessors(comps.begin(), comps.begin() + i);
+            std::vector<std::tuple<tiramisu::var, int>> factors = implicit_function->correcting_loop_fusion_with_shifting(predecessors, *comps[i], levels);
 
-            if (value != 0)
+            // no shift makes this computation legal to fuse, the remaining ones are left unfused. Tiramisu cannot
+            // remove edges from the sched graph, so the computations fused so far stay fused and the function has to
+            // be discarded (see apply_action).
+            if (factors.size() == 0)
             {
-                comps[1]->shift(var, value);
+                append_additional_info(result, "fusion_failed:" + comps[i]->get_name());
+                is_legal = false;
+                break;
             }
-        }
 
-        is_legal &= factors.size() > 0;
+            for (const auto &tuple : factors)
+            {
+                tiramisu::var var = std::get<0>(tuple);
+                int value = std::get<1>(tuple);
+
+                if (value != 0)
+                {
+                    comps[i]->shift(var, value);
+                }
+            }
+        }
         break;
     }
     case 'T':
     {
-        if (action_str[1] == '1')
-        {
-            std::string regex_str = "T1\\(L(\\d),(\\d+),comps=\\[([\\w', ]*)\\]\\)";
-            std::regex re(regex_str);
-            std::smatch match;
-            std::regex_search(action_str, match, re);
-            int level1 = std::stoi(match[1]);
-            int factor1 = std::stoi(match[2]);
-            std::string comps_str = match[3];
-            comps_str.erase(std::remove_if(comps_str.begin(), comps_str.end(), isSingleQuoteOrWhiteSpace), comps_str.end());
-            // COMPS NEED TO BE ORDERED BY APPEARANCE
-            auto comps = get_comps(comps_str, implicit_function);
-            for (auto comp : comps)
-            {
-                comp->tile(level1, factor1);
-            }
-            if (comps.size() > 1)
-                implicit_function->fuse_comps_after_tiling(comps, 1);
-        }
-        else if (action_str[1] == '2')
-        {
-            std::string regex_str = "T2\\(L(\\d),L(\\d),(\\d+),(\\d+),comps=\\[([\\w', ]*)\\]\\)";
-            std::regex re(regex_str);
-            std::smatch match;
-            std::regex_search(action_str, match, re);
-            int level1 = std::stoi(match[1]);
-            int level2 = std::stoi(match[2]);
-            int factor1 = std::stoi(match[3]);
-            int factor2 = std::stoi(match[4]);
-            std::string comps_str = match[5];
-            comps_str.erase(std::remove_if(comps_str.begin(), comps_str.end(), isSingleQuoteOrWhiteSpace), comps_str.end());
-            // COMPS NEED TO BE ORDERED BY APPEARANCE
-            auto comps = get_comps(comps_str, implicit_function);
-            for (auto comp : comps)
+        // T1/T2/T3(Lx,...,fx,...,comps=[...]) or T(levels=[Lx,...],factors=[fx,...],parallel=1,comps=[...])
+        auto action = parse_action_str(action_str);
+        std::vector<int> levels;
+        std::vector<int> factors;
+        bool parallel = false;
+        if (action.name == "T")
+        {
+            for (auto &arg : action.args)
             {
-                comp->tile(level1, level2, factor1, factor2);
+                if (arg.rfind("levels=", 0) == 0)
+                    levels = parse_int_list(arg.substr(7));
+                else if (arg.rfind("factors=", 0) == 0)
+                    factors = parse_int_list(arg.substr(8));
+                else if (arg.rfind("parallel=", 0) == 0)
+                    parallel = arg.substr(9) == "1" || arg.substr(9) == "True" || arg.substr(9) == "true";
             }
-            if (comps.size() > 1)
-                implicit_function->fuse_comps_after_tiling(comps, 2);
-        }
-        else if (action_str[1] == '3')
-        {
-            std::string regex_str = "T3\\(L(\\d),L(\\d),L(\\d),(\\d+),(\\d+),(\\d+),comps=\\[([\\w', ]*)\\]\\)";
-            std::regex re(regex_str);
-            std::smatch match;
-            std::regex_search(action_str, match, re);
-            int level1 = std::stoi(match[1]);
-            int level2 = std::stoi(match[2]);
-            int level3 = std::stoi(match[3]);
-            int factor1 = std::stoi(match[4]);
-            int factor2 = std::stoi(match[5]);
-            int factor3 = std::stoi(match[6]);
-            std::string comps_str = match[7];
-            comps_str.erase(std::remove_if(comps_str.begin(), comps_str.end(), isSingleQuoteOrWhiteSpace), comps_str.end());
-            auto comps = get_comps(comps_str, implicit_function);
-            for (auto comp : comps)
+        }
+        else if (action.name == "T1" || action.name == "T2" || action.name == "T3")
+        {
+            int depth = action.name[1] - '0';
+            if ((int)action.args.size() != 2 * depth)
+                throw std::invalid_argument("Wrong number of arguments in " + action_str);
+            for (int i = 0; i < depth; i++)
             {
-                comp->tile(level1, level2, level3, factor1, factor2, factor3);
+                levels.push_back(parse_int_list(action.args[i])[0]);
+                factors.push_back(std::stoi(action.args[depth + i]));
             }
-            if (comps.size() > 1)
-                implicit_function->fuse_comps_after_tiling(comps, 3);
         }
         else
         {
-            throw std::invalid_argument("Tiling only supports 1D, 2D, and 3D");
+            throw std::invalid_argument("Unknown tiling action " + action.name);
         }
+
+        // COMPS NEED TO BE ORDERED BY APPEARANCE
+        std::vector<tiramisu::computation *> comps;
+        for (auto &comp_name : action.comps)
+        {
+            comps.push_back(get_computation_by_name(comp_name, implicit_function));
+        }
+
+        // the T1/T2/T3 forms rely on the final legality check of the function like before
+        is_legal = apply_tiling(levels, factors, comps, implicit_function, parallel, action.name == "T");
         break;
     }
     case 'M':
@@ -285,6 +871,44 @@ bool apply_action(std::string action_str, tiramisu::function *implicit_function,
         comps[0]->matrix_transform(factors_2d);
         break;
     }
+    case 'C':
+    {
+        // CA(Lk,comps=['producer','consumer'])
+        auto action = parse_action_str(action_str);
+        if (action.name != "CA" || action.args.size() != 1 || action.comps.size() != 2)
+            throw std::invalid_argument("Wrong compute_at action " + action_str);
+
+        int level = parse_int_list(action.args[0])[0];
+        auto producer = get_computation_by_name(action.comps[0], implicit_function);
+        auto consumer = get_computation_by_name(action.comps[1], implicit_function);
+        is_legal = apply_compute_at(producer, consumer, level, implicit_function, result);
+        break;
+    }
+    case 'L':
+    {
+        // Layout([p0,p1,...],pad=N,comps=[...])
+        auto action = parse_action_str(action_str);
+        if (action.name != "Layout" || action.args.empty() || action.comps.empty())
+            throw std::invalid_argument("Wrong layout action " + action_str);
+
+        auto permutation = parse_int_list(action.args[0]);
+        int padding = 0;
+        for (size_t i = 1; i < action.args.size(); i++)
+        {
+            if (action.args[i].rfind("pad=", 0) == 0)
+                padding = std::stoi(action.args[i].substr(4));
+        }
+
+        // computations that share a buffer only change its layout once
+        std::set<std::string> buffer_names;
+        for (auto &comp_name : action.comps)
+        {
+            auto comp = get_computation_by_name(comp_name, implicit_function);
+            if (buffer_names.insert(isl_map_get_tuple_name(comp->get_access_relation(), isl_dim_out)).second)
+                is_legal &= apply_layout(comp, permutation, padding, implicit_function, result);
+        }
+        break;
+    }
 
     default:
         std::cerr << "No action" << std::endl;
@@ -296,6 +920,9 @@ bool apply_action(std::string action_str, tiramisu::function *implicit_function,
 
 bool apply_actions_from_schedule_str(std::string schedule_str, tiramisu::function *implicit_function, Result &result)
 {
+    // the schedule is applied to a function that was just built
+    computed_at_producers.erase(implicit_function);
+
     std::string delimiter = "|";
     size_t pos = 0;
     std::string token;
@@ -315,7 +942,176 @@ bool apply_actions_from_schedule_str(std::string schedule_str, tiramisu::functio
     return is_legal;
 }
 
-Result schedule_str_to_result(std::string function_name, std::string schedule_str, Operation operation, std::vector<tiramisu::buffer *> buffers)
+// The process of the cost model. It speaks the protocol of the auto-scheduler's evaluate_by_learning_model: it
+// reads the program JSON and the schedule JSON of a schedule and answers with the predicted speedup on a line.
+struct CostModelProcess
+{
+    pid_t pid;
+    FILE *input;
+    FILE *output;
+};
+
+// The model runs in a separate process that is started on the first prediction and reused by all the following ones
+static CostModelProcess *get_cost_model()
+{
+    static std::unique_ptr<CostModelProcess> model;
+    if (!model)
+    {
+        char *model_script = getenv("TIRAMISU_MODEL_SCRIPT");
+        if (model_script == NULL)
+            throw std::runtime_error("TIRAMISU_MODEL_SCRIPT must point to the cost model script to make predictions");
+        char *model_python = getenv("TIRAMISU_MODEL_PYTHON");
+        std::string python = model_python == NULL ? "/usr/bin/python3" : model_python;
+        std::vector<char *> argv = {(char *)python.c_str(), model_script, nullptr};
+
+        // the processes started later (wrappers, compilers) must not inherit the pipes of the model
+        int to_model[2], from_model[2];
+        if (pipe2(to_model, O_CLOEXEC) != 0 || pipe2(from_model, O_CLOEXEC) != 0)
+            throw std::runtime_error("pipe() failed!");
+        pid_t pid = fork();
+        if (pid < 0)
+            throw std::runtime_error("fork() failed!");
+        if (pid == 0)
+        {
+            dup2(to_model[0], STDIN_FILENO);
+            dup2(from_model[1], STDOUT_FILENO);
+            execv(argv[0], argv.data());
+            _exit(127);
+        }
+        close(to_model[0]);
+        close(from_model[1]);
+        model = std::make_unique<CostModelProcess>(CostModelProcess{pid, fdopen(to_model[1], "w"), fdopen(from_model[0], "r")});
+    }
+    return model.get();
+}
+
+// Describes an action the way the auto-scheduler records its own optimizations, returns false for the actions the cost model does not know
+static bool get_optimization_info(std::string action_str, tiramisu::function *implicit_function, std::vector<std::pair<int, int>> &skewing_factors, tiramisu::auto_scheduler::optimization_info &info)
+{
+    auto action = parse_action_str(action_str);
+    for (auto &comp_name : action.comps)
+        info.comps.push_back(get_computation_by_name(comp_name, implicit_function));
+    std::vector<int> args;
+    for (auto &arg : action.args)
+    {
+        if (arg[0] == 'L' || arg[0] == '-' || std::isdigit(arg[0]))
+            args.push_back(parse_int_list(arg)[0]);
+    }
+
+    info.nb_l = 1;
+    info.l0 = args.size() > 0 ? args[0] : 0;
+    if (action.name == "P")
+    {
+        info.type = tiramisu::auto_scheduler::optimization_type::PARALLELIZE;
+    }
+    else if (action.name == "U" || action.name == "V" || action.name == "Shift")
+    {
+        info.type = action.name == "U" ? tiramisu::auto_scheduler::optimization_type::UNROLLING : action.name == "V" ? tiramisu::auto_scheduler::optimization_type::VECTORIZATION
+                                                                                                                    : tiramisu::auto_scheduler::optimization_type::SHIFTING;
+        info.l0_fact = args[1];
+    }
+    else if (action.name == "I")
+    {
+        info.type = tiramisu::auto_scheduler::optimization_type::INTERCHANGE;
+        info.nb_l = 2;
+        info.l1 = args[1];
+    }
+    else if (action.name == "S")
+    {
+        // the factors found by the solver are the ones reported in additional_info, in order
+        info.type = tiramisu::auto_scheduler::optimization_type::SKEWING;
+        info.nb_l = 2;
+        info.l1 = args[1];
+        info.l0_fact = skewing_factors.front().first;
+        info.l1_fact = skewing_factors.front().second;
+        skewing_factors.erase(skewing_factors.begin());
+    }
+    else if (action.name == "T1" || action.name == "T2" || action.name == "T3")
+    {
+        info.type = tiramisu::auto_scheduler::optimization_type::TILING;
+        info.nb_l = action.name[1] - '0';
+        std::vector<int *> levels = {&info.l0, &info.l1, &info.l2};
+        std::vector<int *> factors = {&info.l0_fact, &info.l1_fact, &info.l2_fact};
+        for (int i = 0; i < info.nb_l; i++)
+        {
+            *levels[i] = args[i];
+            *factors[i] = args[info.nb_l + i];
+        }
+    }
+    else if (action.name == "F")
+    {
+        info.type = tiramisu::auto_scheduler::optimization_type::FUSION;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+// Input of the cost model for the schedule: the program before any action and the actions as optimizations.
+// Empty when the model does not support one of the actions.
+static std::string get_prediction_input(std::string schedule_str, tiramisu::auto_scheduler::syntax_tree &ast, tiramisu::function *implicit_function, Result &result)
+{
+    std::vector<std::pair<int, int>> skewing_factors;
+    std::stringstream info_stream(result.additional_info);
+    std::string info_str;
+    while (std::getline(info_stream, info_str, ';'))
+    {
+        if (info_str.rfind("skewing_factors:", 0) == 0)
+        {
+            auto factors = parse_int_list(info_str.substr(16));
+            skewing_factors.push_back({factors[0], factors[1]});
+        }
+    }
+
+    std::stringstream schedule_stream(schedule_str);
+    std::string action_str;
+    while (std::getline(schedule_stream, action_str, '|'))
+    {
+        if (action_str.empty())
+            continue;
+        tiramisu::auto_scheduler::optimization_info info;
+        if (!get_optimization_info(action_str, implicit_function, skewing_factors, info))
+        {
+            append_additional_info(result, "prediction_unsupported:" + parse_action_str(action_str).name);
+            return "";
+        }
+        ast.transform_ast(info);
+        ast.new_optims.push_back(info);
+    }
+    return tiramisu::auto_scheduler::evaluate_by_learning_model::get_program_json(ast) +
+           tiramisu::auto_scheduler::evaluate_by_learning_model::get_schedule_json(ast);
+}
+
+std::vector<double> predict_speedups(std::vector<std::string> prediction_inputs)
+{
+    std::vector<double> speedups;
+    if (prediction_inputs.empty())
+        return speedups;
+
+    // the inputs are written in chunks before reading their answers: the answers of a chunk stay far below the
+    // capacity of the pipe, so the model never blocks on its output while this process writes to its input
+    const size_t chunk_size = 64;
+    auto model = get_cost_model();
+    for (size_t begin = 0; begin < prediction_inputs.size(); begin += chunk_size)
+    {
+        size_t end = std::min(begin + chunk_size, prediction_inputs.size());
+        for (size_t i = begin; i < end; i++)
+            fputs(prediction_inputs[i].c_str(), model->input);
+        fflush(model->input);
+        for (size_t i = begin; i < end; i++)
+        {
+            float speedup = 0;
+            if (fscanf(model->output, "%f", &speedup) != 1)
+                throw std::runtime_error("The cost model did not return a speedup");
+            speedups.push_back(speedup);
+        }
+    }
+    return speedups;
+}
+
+Result schedule_str_to_result(std::string function_name, std::string schedule_str, Operation operation, std::vector<tiramisu::buffer *> buffers, std::string *prediction_input)
 {
     Result result = {
         .name = function_name,
@@ -327,69 +1123,112 @@ Result schedule_str_to_result(std::string function_name, std::string schedule_st
 
     auto implicit_function = tiramisu::global::get_implicit_function();
 
-    tiramisu::prepare_schedules_for_legality_checks();
-    tiramisu::perform_full_dependency_analysis();
+    perform_dependency_analysis_with_snapshot(function_name, implicit_function);
     bool is_legal = true;
 
+    // the solver results and the reference outputs are cached for the program before any action
+    std::string function_hash;
+    if (operation == Operation::skewing_solver || operation == Operation::execution)
+        function_hash = get_function_source_hash(implicit_function);
+
+    // the cost model takes the program before any action and the actions as a list of optimizations
+    std::unique_ptr<tiramisu::auto_scheduler::syntax_tree> ast;
+    if (operation == Operation::prediction)
+        ast = std::make_unique<tiramisu::auto_scheduler::syntax_tree>(implicit_function, std::vector<std::string>{});
+
+    // equivalent schedules are reduced to the same (and usually shorter) list of actions
+    schedule_str = canonicalize_schedule_str(schedule_str);
     is_legal &= apply_actions_from_schedule_str(schedule_str, implicit_function, result);
 
     tiramisu::prepare_schedules_for_legality_checks();
-    is_legal &= tiramisu::check_legality_of_function();
+    is_legal &= check_legality_of_scheduled_function(implicit_function);
     result.legality = is_legal;
     implicit_function->gen_time_space_domain();
     implicit_function->gen_isl_ast();
     std::string isl_ast = implicit_function->generate_isl_ast_representation_string(nullptr, 0, "");
     result.isl_ast = isl_ast;
 
-    if (is_legal && operation == Operation::execution)
+    if (is_legal && operation == Operation::prediction)
     {
-        tiramisu::codegen(buffers, function_name + ".o");
+        std::string input = get_prediction_input(schedule_str, *ast, implicit_function, result);
+        if (prediction_input != nullptr)
+            *prediction_input = input;
+        else if (!input.empty())
+            result.predicted_speedup = predict_speedups({input})[0];
+    }
 
-        std::string gpp_command = "g++";
-        std::string wrapper_cmd = "./" + function_name + "_wrapper";
+    if (is_legal && operation == Operation::skewing_solver)
+    {
+        result.skewing_candidates = get_skewing_candidates(function_name, function_hash, schedule_str, implicit_function);
+    }
 
-        std::string gcc_cmd = gpp_command + " -shared -o " + function_name + ".o.so " + function_name + ".o";
-        // run the command and retrieve the execution status
-        int status = system(gcc_cmd.c_str());
-        assert(status != 139 && "Segmentation Fault when trying to execute schedule");
-        // write the wrapper to a file if it does not exist
-        if (!file_exists(function_name + "_wrapper"))
-        {
-// if USE_SQLITE is defined, write the wrapper to a file else raise an error
-#ifdef USE_SQLITE
-            if (write_wrapper_from_db(function_name))
-            {
-                std::cout << "Error: could not write wrapper to file" << std::endl;
-                // exit with error
-                exit(1);
-            };
-#else
-            compile_wrapper(function_name);
-#endif
-        }
-        // run the wrapper
-        auto res_tuple = exec(wrapper_cmd.c_str());
-        result.success = std::get<0>(res_tuple);
-        result.exec_times = std::get<1>(res_tuple);
-        // remove new line character
-        if (!result.exec_times.empty() && result.exec_times[result.exec_times.length() - 1] == '\n')
-        {
-            result.exec_times.erase(result.exec_times.length() - 1);
-        }
+    if (is_legal && operation == Operation::execution)
+    {
+        execute_function(function_name, function_hash, buffers, result);
     }
     return result;
 }
 
+std::string get_program_annotations(tiramisu::function *implicit_function)
+{
+    auto ast = tiramisu::auto_scheduler::syntax_tree(implicit_function, {});
+    return tiramisu::auto_scheduler::evaluate_by_learning_model::get_program_json(ast);
+}
+
+// Runs this executable again without schedule and with TIRAMISU_RECORD_REFERENCE set to recording_path
+static void record_reference_in_child(std::string recording_path)
+{
+    char executable[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", executable, sizeof(executable) - 1);
+    if (length <= 0)
+        return;
+    executable[length] = '\0';
+
+    // the environment is built before forking, the child only calls async-signal-safe functions
+    std::vector<std::string> environment;
+    for (char **variable = environ; *variable != NULL; variable++)
+    {
+        if (std::string(*variable).rfind("TIRAMISU_RECORD_REFERENCE=", 0) != 0)
+            environment.push_back(*variable);
+    }
+    environment.push_back("TIRAMISU_RECORD_REFERENCE=" + recording_path);
+    std::vector<char *> envp;
+    for (auto &variable : environment)
+        envp.push_back(const_cast<char *>(variable.c_str()));
+    envp.push_back(NULL);
+    std::vector<char *> argv = {executable, const_cast<char *>("execution"), const_cast<char *>(""), NULL};
+
+    pid_t pid = fork();
+    if (pid == -1)
+        throw std::runtime_error("fork() failed!");
+    if (pid == 0)
+    {
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd != -1)
+            dup2(null_fd, STDOUT_FILENO);
+        execve(argv[0], argv.data(), envp.data());
+        _exit(127);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+}
+
 void schedule_str_to_result_str(std::string function_name, std::string schedule_str, Operation operation, std::vector<tiramisu::buffer *> buffers)
 {
     if (operation == Operation::annotations)
     {
-        auto ast = tiramisu::auto_scheduler::syntax_tree(tiramisu::global::get_implicit_function(), {});
-        std::string program_json = tiramisu::auto_scheduler::evaluate_by_learning_model::get_program_json(ast);
-        std::cout << program_json;
+        std::cout << get_program_annotations(tiramisu::global::get_implicit_function());
         return;
     }
 
+    // the program runs itself without schedule to record the reference outputs, before generating the scheduled code
+    if (operation == Operation::execution && get_execution_options().validate)
+    {
+        auto implicit_function = tiramisu::global::get_implicit_function();
+        tiramisu::prepare_schedules_for_legality_checks();
+        ensure_reference_output(function_name, get_function_source_hash(implicit_function), record_reference_in_child);
+    }
+
     auto result = schedule_str_to_result(function_name, schedule_str, operation, buffers);
     std::cout << serialize_result(result) << std::endl;
 }
\ No newline at end of file
@@ -0,0 +1,197 @@
+#include <TiraLibCPP/async_evaluator.h>
+
+#include <algorithm>
+#include <atomic>
+#include <fcntl.h>
+#include <filesystem>
+#include <signal.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+struct AsyncRequestState
+{
+    uint64_t id;
+    pid_t pid;
+    size_t slot;
+    std::atomic<bool> cancelled;
+    // set under the mutex once the process exited, its pid (and process group) must not be signaled anymore
+    bool exited = false;
+    std::promise<Result> promise;
+};
+
+AsyncEvaluator::AsyncEvaluator(std::string executable_path, size_t max_in_flight, std::string work_dir)
+    : executable_path(fs::absolute(executable_path).string()),
+      function_name(fs::path(executable_path).filename().string()),
+      max_in_flight(max_in_flight)
+{
+    if (max_in_flight == 0)
+        throw std::invalid_argument("max_in_flight must be at least 1");
+
+    if (work_dir.empty())
+        work_dir = (fs::current_path() / (function_name + "_async")).string();
+
+    // the wrapper is looked up in the working directory of the generated executable
+    std::vector<std::string> wrapper_files = {function_name + "_wrapper", function_name + "_wrapper.cpp"};
+    for (size_t slot = 0; slot < max_in_flight; slot++)
+    {
+        std::string slot_dir = work_dir + "/slot_" + std::to_string(slot);
+        fs::create_directories(slot_dir);
+        for (auto &wrapper_file : wrapper_files)
+        {
+            std::error_code ec;
+            if (file_exists(wrapper_file) && !fs::exists(slot_dir + "/" + wrapper_file))
+                fs::create_symlink(fs::absolute(wrapper_file), slot_dir + "/" + wrapper_file, ec);
+        }
+        slot_dirs.push_back(slot_dir);
+        slot_used.push_back(false);
+    }
+}
+
+AsyncEvaluator::~AsyncEvaluator()
+{
+    cancel_all();
+    std::unique_lock<std::mutex> lock(mutex);
+    slot_released.wait(lock, [this]()
+                       { return requests.empty(); });
+}
+
+AsyncRequest AsyncEvaluator::submit(std::string schedule_str, Operation operation)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    slot_released.wait(lock, [this]()
+                       { return requests.size() < max_in_flight; });
+    return start_request(schedule_str, operation);
+}
+
+bool AsyncEvaluator::try_submit(std::string schedule_str, Operation operation, AsyncRequest &request)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (requests.size() >= max_in_flight)
+        return false;
+    request = start_request(schedule_str, operation);
+    return true;
+}
+
+bool AsyncEvaluator::cancel(uint64_t request_id)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    auto it = requests.find(request_id);
+    if (it == requests.end() || it->second->exited)
+        return false;
+    it->second->cancelled = true;
+    // the executable runs g++ and the wrapper in its own process group, kill all of them
+    kill(-it->second->pid, SIGKILL);
+    return true;
+}
+
+void AsyncEvaluator::cancel_all()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (auto &request : requests)
+    {
+        if (request.second->exited)
+            continue;
+        request.second->cancelled = true;
+        kill(-request.second->pid, SIGKILL);
+    }
+}
+
+size_t AsyncEvaluator::in_flight()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    return requests.size();
+}
+
+// must be called with the mutex held and a free slot
+AsyncRequest AsyncEvaluator::start_request(std::string schedule_str, Operation operation)
+{
+    auto state = std::make_shared<AsyncRequestState>();
+    state->id = next_request_id++;
+    state->cancelled = false;
+    state->slot = std::find(slot_used.begin(), slot_used.end(), false) - slot_used.begin();
+
+    std::string operation_str = get_string_from_operation(operation);
+    std::vector<char *> argv = {(char *)executable_path.c_str(), (char *)operation_str.c_str(), (char *)schedule_str.c_str(), nullptr};
+
+    int fds[2];
+    // the other requests must not inherit the pipe, or their end of file would wait for this process too
+    if (pipe2(fds, O_CLOEXEC) != 0)
+        throw std::runtime_error("pipe() failed!");
+
+    pid_t pid = fork();
+    if (pid < 0)
+        throw std::runtime_error("fork() failed!");
+    if (pid == 0)
+    {
+        setpgid(0, 0);
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        if (chdir(slot_dirs[state->slot].c_str()) == 0)
+            execv(argv[0], argv.data());
+        _exit(127);
+    }
+    close(fds[1]);
+    // also set from the parent so that a cancel right after the fork reaches the whole group
+    setpgid(pid, pid);
+
+    state->pid = pid;
+    requests[state->id] = state;
+    slot_used[state->slot] = true;
+
+    AsyncRequest request = {state->id, state->promise.get_future()};
+    std::thread(&AsyncEvaluator::wait_for_request, this, state, fds[0]).detach();
+    return request;
+}
+
+void AsyncEvaluator::wait_for_request(std::shared_ptr<AsyncRequestState> state, int output_fd)
+{
+    std::string output;
+    std::array<char, 4096> buffer;
+    ssize_t nb_read;
+    while ((nb_read = read(output_fd, buffer.data(), buffer.size())) > 0)
+        output.append(buffer.data(), nb_read);
+    close(output_fd);
+
+    // wait for the exit without reaping the process, its pid cannot be reused by another process while it is a zombie
+    siginfo_t info;
+    waitid(P_PID, state->pid, &info, WEXITED | WNOWAIT);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        state->exited = true;
+    }
+    int status = 0;
+    waitpid(state->pid, &status, 0);
+
+    // the serialized result is the last line printed by the generated executable
+    while (!output.empty() && output.back() == '\n')
+        output.pop_back();
+    std::string result_str = output.substr(output.rfind('\n') == std::string::npos ? 0 : output.rfind('\n') + 1);
+
+    Result result;
+    if (!state->cancelled && WIFEXITED(status) && WEXITSTATUS(status) == 0 && !result_str.empty() && result_str[0] == '{')
+    {
+        result = deserialize_result(result_str);
+    }
+    else
+    {
+        result = {
+            .name = function_name,
+            .legality = false,
+            .exec_times = "",
+            .additional_info = state->cancelled ? "cancelled" : "evaluation_failed",
+            .success = false,
+        };
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        requests.erase(state->id);
+        slot_used[state->slot] = false;
+        slot_released.notify_all();
+    }
+    state->promise.set_value(result);
+}
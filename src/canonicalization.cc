@@ -0,0 +1,214 @@
+#include <TiraLibCPP/canonicalization.h>
+#include <TiraLibCPP/utils.h>
+
+#include <algorithm>
+#include <cctype>
+
+static bool isWhiteSpace(char c)
+{
+    return std::isspace(c);
+}
+
+// split on the delimiter, ignoring delimiters nested inside brackets
+static std::vector<std::string> split_top_level(std::string str, char delimiter)
+{
+    std::vector<std::string> tokens;
+    std::string token;
+    int depth = 0;
+    for (char c : str)
+    {
+        if (c == '[' || c == '(')
+            depth++;
+        else if (c == ']' || c == ')')
+            depth--;
+
+        if (c == delimiter && depth == 0)
+        {
+            tokens.push_back(token);
+            token.clear();
+        }
+        else
+        {
+            token += c;
+        }
+    }
+    tokens.push_back(token);
+    return tokens;
+}
+
+ParsedAction parse_action_str(std::string action_str)
+{
+    ParsedAction action;
+    size_t open_pos = action_str.find('(');
+    size_t close_pos = action_str.rfind(')');
+    if (open_pos == std::string::npos || close_pos == std::string::npos || close_pos < open_pos)
+    {
+        action_str.erase(std::remove_if(action_str.begin(), action_str.end(), isWhiteSpace), action_str.end());
+        action.name = action_str;
+        return action;
+    }
+
+    action.name = action_str.substr(0, open_pos);
+    action.name.erase(std::remove_if(action.name.begin(), action.name.end(), isWhiteSpace), action.name.end());
+
+    std::string args_str = action_str.substr(open_pos + 1, close_pos - open_pos - 1);
+    for (auto arg : split_top_level(args_str, ','))
+    {
+        arg.erase(std::remove_if(arg.begin(), arg.end(), isWhiteSpace), arg.end());
+        if (arg.rfind("comps=", 0) == 0)
+        {
+            std::string comps_str = arg.substr(6);
+            comps_str.erase(std::remove_if(comps_str.begin(), comps_str.end(), [](char c)
+                                           { return isSingleQuoteOrWhiteSpace(c) || c == '"' || c == '[' || c == ']'; }),
+                            comps_str.end());
+            for (auto comp : split_top_level(comps_str, ','))
+            {
+                if (!comp.empty())
+                    action.comps.push_back(comp);
+            }
+        }
+        else if (!arg.empty())
+        {
+            action.args.push_back(arg);
+        }
+    }
+    return action;
+}
+
+std::string action_to_str(ParsedAction &action)
+{
+    if (action.args.empty() && action.comps.empty())
+        return action.name;
+
+    std::string action_str = action.name + "(";
+    for (size_t i = 0; i < action.args.size(); i++)
+    {
+        if (i > 0)
+            action_str += ",";
+        action_str += action.args[i];
+    }
+    if (!action.comps.empty())
+    {
+        if (!action.args.empty())
+            action_str += ",";
+        action_str += "comps=[";
+        for (size_t i = 0; i < action.comps.size(); i++)
+        {
+            if (i > 0)
+                action_str += ",";
+            action_str += "'" + action.comps[i] + "'";
+        }
+        action_str += "]";
+    }
+    action_str += ")";
+    return action_str;
+}
+
+// Actions whose result does not depend on the order of their computation list.
+// Fusion, distribution and tiling need the computations ordered by appearance, M applies to a single computation,
+// P tags the first computation and V takes its width from the loop of the first computation.
+static bool has_unordered_comps(std::string name)
+{
+    return name == "I" || name == "R" || name == "S" || name == "Layout" || name == "Shift";
+}
+
+// Actions that are their own inverse when applied twice in a row with the same arguments
+static bool is_involution(std::string name)
+{
+    return name == "I" || name == "R";
+}
+
+static bool is_identity_matrix(std::string matrix_str)
+{
+    matrix_str.erase(std::remove_if(matrix_str.begin(), matrix_str.end(), [](char c)
+                                    { return c == '[' || c == ']'; }),
+                     matrix_str.end());
+    auto factors = split_top_level(matrix_str, ',');
+    size_t num_dims = 0;
+    while (num_dims * num_dims < factors.size())
+        num_dims++;
+    if (num_dims * num_dims != factors.size())
+        return false;
+
+    for (size_t i = 0; i < factors.size(); i++)
+    {
+        std::string expected = (i / num_dims == i % num_dims) ? "1" : "0";
+        if (factors[i] != expected)
+            return false;
+    }
+    return true;
+}
+
+static bool is_identity_permutation(std::string permutation_str)
+{
+    permutation_str.erase(std::remove_if(permutation_str.begin(), permutation_str.end(), [](char c)
+                                         { return c == '[' || c == ']'; }),
+                          permutation_str.end());
+    auto dims = split_top_level(permutation_str, ',');
+    for (size_t i = 0; i < dims.size(); i++)
+    {
+        if (dims[i] != std::to_string(i))
+            return false;
+    }
+    return true;
+}
+
+static bool is_no_op(ParsedAction &action)
+{
+    if (action.name.empty())
+        return true;
+    if (action.name == "Shift" && action.args.size() == 2 && action.args[1] == "0")
+        return true;
+    if (action.name == "I" && action.args.size() == 2 && action.args[0] == action.args[1])
+        return true;
+    if (action.name == "M" && action.args.size() == 1 && is_identity_matrix(action.args[0]))
+        return true;
+    if (action.name == "Layout" && action.args.size() == 1 && is_identity_permutation(action.args[0]))
+        return true;
+    return false;
+}
+
+std::string canonicalize_action_str(std::string action_str)
+{
+    auto action = parse_action_str(action_str);
+
+    if (has_unordered_comps(action.name))
+        std::sort(action.comps.begin(), action.comps.end());
+
+    // interchange is symmetric in its two levels
+    if (action.name == "I" && action.args.size() == 2 && action.args[1] < action.args[0])
+        std::swap(action.args[0], action.args[1]);
+
+    if (is_no_op(action))
+        return "";
+
+    return action_to_str(action);
+}
+
+std::string canonicalize_schedule_str(std::string schedule_str)
+{
+    std::vector<std::string> actions;
+    for (auto action_str : split_top_level(schedule_str, '|'))
+    {
+        std::string canonical_action = canonicalize_action_str(action_str);
+        if (canonical_action.empty())
+            continue;
+
+        // I(L0,L1) followed by I(L0,L1) or R(L0) followed by R(L0) on the same computations cancel out
+        if (!actions.empty() && actions.back() == canonical_action && is_involution(parse_action_str(canonical_action).name))
+        {
+            actions.pop_back();
+            continue;
+        }
+        actions.push_back(canonical_action);
+    }
+
+    std::string canonical_schedule;
+    for (size_t i = 0; i < actions.size(); i++)
+    {
+        if (i > 0)
+            canonical_schedule += "|";
+        canonical_schedule += actions[i];
+    }
+    return canonical_schedule;
+}
@@ -0,0 +1,193 @@
+#include <TiraLibCPP/cpu_topology.h>
+
+#include <sched.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+std::vector<int> parse_cpu_list(std::string cpu_list)
+{
+    std::vector<int> cpus;
+    std::stringstream ss(cpu_list);
+    std::string range;
+    while (std::getline(ss, range, ','))
+    {
+        range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+        if (range.empty())
+            continue;
+        size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; cpu++)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+static std::string read_first_line(std::string path)
+{
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+static int read_int(std::string path, int default_value)
+{
+    std::string line = read_first_line(path);
+    return line.empty() ? default_value : std::stoi(line);
+}
+
+std::vector<CPUInfo> get_cpu_topology(std::string sysfs_root)
+{
+    std::vector<int> online = parse_cpu_list(read_first_line(sysfs_root + "/cpu/online"));
+
+    // machines without NUMA have no node directory, all their CPUs are on node 0
+    std::map<int, int> cpu_nodes;
+    std::vector<int> nodes = parse_cpu_list(read_first_line(sysfs_root + "/node/online"));
+    for (int node : nodes)
+    {
+        for (int cpu : parse_cpu_list(read_first_line(sysfs_root + "/node/node" + std::to_string(node) + "/cpulist")))
+            cpu_nodes[cpu] = node;
+    }
+
+    std::vector<CPUInfo> cpus;
+    std::map<std::pair<int, int>, int> threads_per_core;
+    for (int id : online)
+    {
+        std::string topology = sysfs_root + "/cpu/cpu" + std::to_string(id) + "/topology/";
+        CPUInfo cpu;
+        cpu.id = id;
+        cpu.core = read_int(topology + "core_id", id);
+        cpu.package = read_int(topology + "physical_package_id", 0);
+        cpu.node = cpu_nodes.count(id) ? cpu_nodes[id] : 0;
+        cpu.thread = threads_per_core[{cpu.package, cpu.core}]++;
+        cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+std::vector<CPUInfo> get_allowed_cpus()
+{
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    auto cpus = get_cpu_topology();
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return cpus;
+    cpus.erase(std::remove_if(cpus.begin(), cpus.end(), [&allowed](const CPUInfo &cpu)
+                              { return !CPU_ISSET(cpu.id, &allowed); }),
+               cpus.end());
+    return cpus;
+}
+
+std::vector<int> get_affinity_cpus(const std::vector<CPUInfo> &cpus, int nb_threads, std::string policy)
+{
+    std::vector<CPUInfo> ordered = cpus;
+    if (policy == "compact")
+    {
+        std::sort(ordered.begin(), ordered.end(), [](const CPUInfo &a, const CPUInfo &b)
+                  { return std::make_tuple(a.node, a.package, a.core, a.thread) < std::make_tuple(b.node, b.package, b.core, b.thread); });
+    }
+    else if (policy == "scatter")
+    {
+        // the i-th CPU of every node (cores first) before the (i+1)-th one
+        std::sort(ordered.begin(), ordered.end(), [](const CPUInfo &a, const CPUInfo &b)
+                  { return std::make_tuple(a.node, a.thread, a.package, a.core) < std::make_tuple(b.node, b.thread, b.package, b.core); });
+        std::map<int, int> rank_in_node;
+        std::vector<std::pair<int, CPUInfo>> ranked;
+        for (auto &cpu : ordered)
+            ranked.push_back({rank_in_node[cpu.node]++, cpu});
+        std::stable_sort(ranked.begin(), ranked.end(), [](const auto &a, const auto &b)
+                         { return a.first < b.first; });
+        for (size_t i = 0; i < ranked.size(); i++)
+            ordered[i] = ranked[i].second;
+    }
+    else if (policy == "numa")
+    {
+        if (ordered.empty())
+            return {};
+        int node = std::min_element(ordered.begin(), ordered.end(), [](const CPUInfo &a, const CPUInfo &b)
+                                    { return a.id < b.id; })
+                       ->node;
+        ordered.erase(std::remove_if(ordered.begin(), ordered.end(), [node](const CPUInfo &cpu)
+                                     { return cpu.node != node; }),
+                      ordered.end());
+        std::sort(ordered.begin(), ordered.end(), [](const CPUInfo &a, const CPUInfo &b)
+                  { return std::make_tuple(a.thread, a.package, a.core) < std::make_tuple(b.thread, b.package, b.core); });
+    }
+    else
+        throw std::invalid_argument("Unknown affinity policy " + policy);
+
+    if (nb_threads <= 0 || nb_threads > (int)ordered.size())
+        return {};
+    std::vector<int> affinity;
+    for (int i = 0; i < nb_threads; i++)
+        affinity.push_back(ordered[i].id);
+    return affinity;
+}
+
+std::vector<std::vector<int>> partition_cpus(const std::vector<CPUInfo> &cpus, int nb_slots)
+{
+    // CPUs of every core, cores of every node
+    std::map<std::tuple<int, int, int>, std::vector<int>> core_cpus;
+    for (auto &cpu : cpus)
+        core_cpus[{cpu.node, cpu.package, cpu.core}].push_back(cpu.id);
+    std::map<int, std::vector<std::vector<int>>> node_cores;
+    for (auto &core : core_cpus)
+        node_cores[std::get<0>(core.first)].push_back(core.second);
+
+    if (nb_slots <= 0 || nb_slots > (int)core_cpus.size())
+        throw std::invalid_argument("Cannot split " + std::to_string(core_cpus.size()) + " cores into " + std::to_string(nb_slots) + " slots");
+
+    std::vector<std::vector<std::vector<int>>> nodes;
+    for (auto &node : node_cores)
+        nodes.push_back(node.second);
+    int nb_nodes = nodes.size();
+
+    std::vector<std::vector<int>> slots(nb_slots);
+    if (nb_slots <= nb_nodes)
+    {
+        for (int node = 0; node < nb_nodes; node++)
+        {
+            for (auto &core : nodes[node])
+                slots[node * nb_slots / nb_nodes].insert(slots[node * nb_slots / nb_nodes].end(), core.begin(), core.end());
+        }
+    }
+    else
+    {
+        // one slot per node, then every other slot to the node with the most cores per slot
+        std::vector<int> node_slots(nb_nodes, 1);
+        for (int slot = nb_nodes; slot < nb_slots; slot++)
+        {
+            int best = -1;
+            for (int node = 0; node < nb_nodes; node++)
+            {
+                if (node_slots[node] >= (int)nodes[node].size())
+                    continue;
+                if (best == -1 || (double)nodes[node].size() / node_slots[node] > (double)nodes[best].size() / node_slots[best])
+                    best = node;
+            }
+            node_slots[best]++;
+        }
+
+        int first_slot = 0;
+        for (int node = 0; node < nb_nodes; node++)
+        {
+            int nb_cores = nodes[node].size();
+            for (int core = 0; core < nb_cores; core++)
+            {
+                auto &slot = slots[first_slot + core * node_slots[node] / nb_cores];
+                slot.insert(slot.end(), nodes[node][core].begin(), nodes[node][core].end());
+            }
+            first_slot += node_slots[node];
+        }
+    }
+
+    for (auto &slot : slots)
+        std::sort(slot.begin(), slot.end());
+    return slots;
+}
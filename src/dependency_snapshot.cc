@@ -0,0 +1,173 @@
+#include <tiramisu/tiramisu.h>
+#include <isl/union_map.h>
+#include <TiraLibCPP/utils.h>
+#include <TiraLibCPP/dependency_snapshot.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <unistd.h>
+
+// ISL Helpers
+static std::string take_isl_str(char *isl_str)
+{
+    if (isl_str == nullptr)
+        return "";
+    std::string str(isl_str);
+    free(isl_str);
+    return str;
+}
+
+static std::string union_map_to_str(isl_union_map *map)
+{
+    if (map == nullptr)
+        return "";
+    return take_isl_str(isl_union_map_to_str(map));
+}
+
+static isl_union_map *union_map_from_str(isl_ctx *ctx, std::string str)
+{
+    if (str.empty())
+        return nullptr;
+    return isl_union_map_read_from_str(ctx, str.c_str());
+}
+
+std::string get_function_source_hash(tiramisu::function *implicit_function)
+{
+    uint64_t hash = fnv1a_hash("");
+    for (auto comp : implicit_function->get_computations())
+    {
+        hash = fnv1a_hash(comp->get_name(), hash);
+        hash = fnv1a_hash(take_isl_str(isl_set_to_str(comp->get_iteration_domain())), hash);
+        if (comp->get_access_relation() != nullptr)
+            hash = fnv1a_hash(take_isl_str(isl_map_to_str(comp->get_access_relation())), hash);
+        hash = fnv1a_hash(take_isl_str(isl_map_to_str(comp->get_schedule())), hash);
+        hash = fnv1a_hash(comp->get_expr().to_str(), hash);
+    }
+    // the same accesses to differently sized or typed buffers are different programs
+    for (auto &buffer : implicit_function->get_buffers())
+    {
+        hash = fnv1a_hash(buffer.first, hash);
+        hash = fnv1a_hash(std::to_string(buffer.second->get_elements_type()) + " " + std::to_string(buffer.second->get_argument_type()), hash);
+        for (auto &size : buffer.second->get_dim_sizes())
+            hash = fnv1a_hash(size.to_str(), hash);
+    }
+
+    return hash_to_str(hash);
+}
+
+static void write_dependency_snapshot(std::ostream &snapshot_file, std::string function_hash, tiramisu::function *implicit_function)
+{
+    snapshot_file << "hash " << function_hash << "\n";
+    snapshot_file << "raw " << union_map_to_str(implicit_function->get_dep_read_after_write()) << "\n";
+    snapshot_file << "war " << union_map_to_str(implicit_function->get_dep_write_after_read()) << "\n";
+    snapshot_file << "waw " << union_map_to_str(implicit_function->get_dep_write_after_write()) << "\n";
+    snapshot_file << "live_in " << union_map_to_str(implicit_function->get_live_in_access()) << "\n";
+    snapshot_file << "live_out " << union_map_to_str(implicit_function->get_live_out_access()) << "\n";
+    for (auto comp : implicit_function->get_computations())
+    {
+        snapshot_file << "schedule " << comp->get_name() << " " << take_isl_str(isl_map_to_str(comp->get_schedule())) << "\n";
+    }
+}
+
+bool save_dependency_snapshot(std::string snapshot_path, std::string function_hash, tiramisu::function *implicit_function)
+{
+    // write to a temporary file first so that concurrent readers never see a partial snapshot
+    std::string tmp_path = snapshot_path + ".tmp." + std::to_string(getpid());
+    std::ofstream snapshot_file(tmp_path);
+    if (!snapshot_file.is_open())
+        return false;
+
+    write_dependency_snapshot(snapshot_file, function_hash, implicit_function);
+    snapshot_file.close();
+
+    return std::rename(tmp_path.c_str(), snapshot_path.c_str()) == 0;
+}
+
+static bool read_dependency_snapshot(std::istream &snapshot_file, std::string function_hash, tiramisu::function *implicit_function)
+{
+    std::map<std::string, std::string> deps;
+    std::map<std::string, std::string> schedules;
+    std::string line;
+    while (std::getline(snapshot_file, line))
+    {
+        size_t pos = line.find(' ');
+        std::string key = line.substr(0, pos);
+        std::string value = pos == std::string::npos ? "" : line.substr(pos + 1);
+        if (key == "schedule")
+        {
+            pos = value.find(' ');
+            if (pos == std::string::npos)
+                return false;
+            schedules[value.substr(0, pos)] = value.substr(pos + 1);
+        }
+        else
+        {
+            deps[key] = value;
+        }
+    }
+
+    if (deps["hash"] != function_hash)
+        return false;
+
+    auto comps = implicit_function->get_computations();
+    for (auto comp : comps)
+    {
+        if (schedules.find(comp->get_name()) == schedules.end())
+            return false;
+    }
+
+    isl_ctx *ctx = implicit_function->get_isl_ctx();
+    for (auto comp : comps)
+    {
+        comp->set_schedule(isl_map_read_from_str(ctx, schedules[comp->get_name()].c_str()));
+    }
+    implicit_function->set_dep_read_after_write(union_map_from_str(ctx, deps["raw"]));
+    implicit_function->set_dep_write_after_read(union_map_from_str(ctx, deps["war"]));
+    implicit_function->set_dep_write_after_write(union_map_from_str(ctx, deps["waw"]));
+    implicit_function->set_live_in_access(union_map_from_str(ctx, deps["live_in"]));
+    implicit_function->set_live_out_access(union_map_from_str(ctx, deps["live_out"]));
+    return true;
+}
+
+bool load_dependency_snapshot(std::string snapshot_path, std::string function_hash, tiramisu::function *implicit_function)
+{
+    std::ifstream snapshot_file(snapshot_path);
+    if (!snapshot_file.is_open())
+        return false;
+    return read_dependency_snapshot(snapshot_file, function_hash, implicit_function);
+}
+
+// Snapshots of the functions already analyzed by this process, keyed by their source hash.
+// Searches and bindings rebuild the same function for every schedule they evaluate.
+static std::map<std::string, std::string> in_process_snapshots;
+
+void perform_dependency_analysis_with_snapshot(std::string function_name, tiramisu::function *implicit_function)
+{
+    // the ordering of the computations (then/after) is only in their schedules once they are prepared
+    tiramisu::prepare_schedules_for_legality_checks();
+    std::string function_hash = get_function_source_hash(implicit_function);
+
+    auto in_process_snapshot = in_process_snapshots.find(function_hash);
+    if (in_process_snapshot != in_process_snapshots.end())
+    {
+        std::istringstream snapshot_stream(in_process_snapshot->second);
+        if (read_dependency_snapshot(snapshot_stream, function_hash, implicit_function))
+            return;
+    }
+
+    char *cache_dir = getenv("TIRAMISU_DEPS_CACHE_DIR");
+    std::string snapshot_path = cache_dir == NULL ? "" : std::string(cache_dir) + "/" + function_name + "_deps.txt";
+    // the snapshot is missing or was computed for a different program
+    if (snapshot_path.empty() || !load_dependency_snapshot(snapshot_path, function_hash, implicit_function))
+    {
+        tiramisu::perform_full_dependency_analysis();
+        if (!snapshot_path.empty() && !save_dependency_snapshot(snapshot_path, function_hash, implicit_function))
+            std::cerr << "Could not write dependency snapshot to " << snapshot_path << std::endl;
+    }
+
+    std::ostringstream snapshot_stream;
+    write_dependency_snapshot(snapshot_stream, function_hash, implicit_function);
+    in_process_snapshots[function_hash] = snapshot_stream.str();
+}
@@ -0,0 +1,832 @@
+#include <tiramisu/tiramisu.h>
+#include <TiraLibCPP/cpu_topology.h>
+#include <TiraLibCPP/execution.h>
+#include <TiraLibCPP/roofline.h>
+#ifdef USE_SQLITE
+#include <TiraLibCPP/dbhelpers.h>
+#endif
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <thread>
+
+// where the builtin wrappers find wrapper_runtime.h, set by CMake
+#ifndef TIRALIBCPP_INCLUDE_DIRS
+#define TIRALIBCPP_INCLUDE_DIRS ""
+#endif
+
+extern char **environ;
+
+static bool get_env_flag(const char *name)
+{
+    char *value = getenv(name);
+    return value != NULL && std::string(value) != "" && std::string(value) != "0";
+}
+
+static int get_env_int(const char *name, int default_value)
+{
+    char *value = getenv(name);
+    if (value == NULL || std::string(value) == "")
+        return default_value;
+    return std::stoi(value);
+}
+
+static std::vector<std::string> get_env_list(const char *name, std::vector<std::string> default_value)
+{
+    char *value = getenv(name);
+    if (value == NULL || std::string(value) == "")
+        return default_value;
+    std::vector<std::string> list;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        if (!item.empty())
+            list.push_back(item);
+    }
+    return list;
+}
+
+// set while ensure_reference_output runs the unscheduled function in the process
+static std::string recording_reference;
+
+ExecutionOptions get_execution_options()
+{
+    ExecutionOptions options;
+    options.builtin_wrapper = get_env_flag("TIRAMISU_BUILTIN_WRAPPER");
+    options.nb_exec = get_env_int("TIRAMISU_NB_EXEC", options.nb_exec);
+    options.perf_counters = get_env_flag("TIRAMISU_PERF_COUNTERS");
+    if (getenv("TIRAMISU_CACHE_MODE") != NULL)
+        options.cache_mode = getenv("TIRAMISU_CACHE_MODE");
+    if (options.cache_mode != "" && options.cache_mode != "warm" && options.cache_mode != "cold")
+        throw std::invalid_argument("Unknown cache mode " + options.cache_mode);
+
+    options.hugepages = get_env_list("TIRAMISU_HUGEPAGES", {options.hugepages})[0];
+    options.numa = get_env_list("TIRAMISU_NUMA", {options.numa})[0];
+    options.fill = get_env_list("TIRAMISU_FILL", {options.fill})[0];
+    options.fill_seed = std::stoull(get_env_list("TIRAMISU_FILL_SEED", {"0"})[0]);
+    if (options.hugepages != "none" && options.hugepages != "transparent" && options.hugepages != "explicit")
+        throw std::invalid_argument("Unknown huge pages mode " + options.hugepages);
+    if (options.numa != "default" && options.numa != "interleave" && options.numa != "local" && options.numa != "first_touch")
+        throw std::invalid_argument("Unknown NUMA policy " + options.numa);
+    if (options.fill != "random" && options.fill != "index" && options.fill != "zero")
+        throw std::invalid_argument("Unknown fill pattern " + options.fill);
+    if (getenv("TIRAMISU_PROBLEM_SIZES") != NULL)
+        options.problem_sizes = getenv("TIRAMISU_PROBLEM_SIZES");
+    options.validate = get_env_flag("TIRAMISU_VALIDATE");
+    options.roofline = get_env_flag("TIRAMISU_ROOFLINE");
+    options.validation_rtol = std::stod(get_env_list("TIRAMISU_VALIDATION_RTOL", {"-1"})[0]);
+    options.validation_atol = std::stod(get_env_list("TIRAMISU_VALIDATION_ATOL", {"-1"})[0]);
+    options.record_reference = !recording_reference.empty() ? recording_reference : get_env_list("TIRAMISU_RECORD_REFERENCE", {""})[0];
+    for (auto &nb_threads : get_env_list("TIRAMISU_THREAD_COUNTS", {}))
+        options.thread_counts.push_back(std::stoi(nb_threads));
+    options.affinity_policies = get_env_list("TIRAMISU_AFFINITY", options.affinity_policies);
+    options.measurement_slots = get_env_int("TIRAMISU_MEASUREMENT_SLOTS", options.measurement_slots);
+    if (getenv("TIRAMISU_SLOT_LOCK_DIR") != NULL)
+        options.slot_lock_dir = getenv("TIRAMISU_SLOT_LOCK_DIR");
+    if (getenv("TIRAMISU_SLOT_CGROUP") != NULL)
+        options.slot_cgroup = getenv("TIRAMISU_SLOT_CGROUP");
+    return options;
+}
+
+static std::string get_c_type(tiramisu::primitive_t type)
+{
+    switch (type)
+    {
+    case tiramisu::p_uint8:
+        return "uint8_t";
+    case tiramisu::p_int8:
+        return "int8_t";
+    case tiramisu::p_uint16:
+        return "uint16_t";
+    case tiramisu::p_int16:
+        return "int16_t";
+    case tiramisu::p_uint32:
+        return "uint32_t";
+    case tiramisu::p_int32:
+        return "int32_t";
+    case tiramisu::p_uint64:
+        return "uint64_t";
+    case tiramisu::p_int64:
+        return "int64_t";
+    case tiramisu::p_float32:
+        return "float";
+    case tiramisu::p_float64:
+        return "double";
+    case tiramisu::p_boolean:
+        return "bool";
+    default:
+        throw std::invalid_argument("Unsupported buffer type in the builtin wrapper");
+    }
+}
+
+// C++ expression of a buffer size, the size parameters it uses are added to size_parameters
+static std::string get_size_expression(const tiramisu::expr &size, std::set<std::string> &size_parameters)
+{
+    if (size.is_constant())
+        return std::to_string(size.get_int32_value());
+    if (size.get_expr_type() == tiramisu::e_var)
+    {
+        size_parameters.insert(size.get_name());
+        return "param_" + size.get_name();
+    }
+    if (size.get_expr_type() == tiramisu::e_op && size.get_op_type() == tiramisu::o_minus)
+        return "(-" + get_size_expression(size.get_operand(0), size_parameters) + ")";
+
+    std::map<tiramisu::op_t, std::string> operators = {
+        {tiramisu::o_add, " + "}, {tiramisu::o_sub, " - "}, {tiramisu::o_mul, " * "}, {tiramisu::o_div, " / "}, {tiramisu::o_mod, " % "}};
+    if (size.get_expr_type() == tiramisu::e_op && operators.count(size.get_op_type()))
+        return "(" + get_size_expression(size.get_operand(0), size_parameters) + operators[size.get_op_type()] + get_size_expression(size.get_operand(1), size_parameters) + ")";
+    if (size.get_expr_type() == tiramisu::e_op && (size.get_op_type() == tiramisu::o_max || size.get_op_type() == tiramisu::o_min))
+        return std::string(size.get_op_type() == tiramisu::o_max ? "std::max" : "std::min") + "<int32_t>(" + get_size_expression(size.get_operand(0), size_parameters) + ", " + get_size_expression(size.get_operand(1), size_parameters) + ")";
+    throw std::invalid_argument("The builtin wrapper cannot evaluate the buffer size " + size.to_str());
+}
+
+// the declarations of the buffers, the parameter types and the arguments of the function
+static void get_wrapper_buffers(std::vector<tiramisu::buffer *> buffers, std::string &allocations, std::string &parameters, std::string &arguments, std::set<std::string> &size_parameters)
+{
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+        std::string sizes;
+        for (auto &size : buffers[i]->get_dim_sizes())
+            sizes += (sizes.empty() ? "" : ", ") + get_size_expression(size, size_parameters);
+
+        std::string variable = "buf_" + buffers[i]->get_name();
+        std::string is_output = buffers[i]->get_argument_type() == tiramisu::a_output ? ", true" : "";
+        allocations += "    tiralib::Buffer<" + get_c_type(buffers[i]->get_elements_type()) + "> " + variable + "(\"" + buffers[i]->get_name() + "\", {" + sizes + "}" + is_output + ");\n";
+        parameters += std::string(i > 0 ? ", " : "") + "halide_buffer_t *";
+        arguments += std::string(i > 0 ? ", " : "") + variable + ".raw()";
+    }
+}
+
+bool is_parametric(std::vector<tiramisu::buffer *> buffers)
+{
+    for (auto buffer : buffers)
+    {
+        for (auto &size : buffer->get_dim_sizes())
+        {
+            if (!size.is_constant())
+                return true;
+        }
+    }
+    return false;
+}
+
+std::string generate_wrapper_source(std::string function_name, std::vector<tiramisu::buffer *> buffers)
+{
+    std::string allocations, parameters, arguments;
+    std::set<std::string> size_parameters;
+    get_wrapper_buffers(buffers, allocations, parameters, arguments, size_parameters);
+
+    std::string source = "// Generated by TiraLibCPP from the buffers of " + function_name + "\n";
+    source += "#include <TiraLibCPP/wrapper_runtime.h>\n\n";
+    source += "extern \"C\" int " + function_name + "(" + parameters + ");\n\n";
+    source += "int main()\n{\n";
+    // the buffers of parametric functions are allocated again for every problem size
+    if (!size_parameters.empty())
+    {
+        source += "    return tiralib::measure_problem_sizes([&](const tiralib::ProblemSize &size, tiralib::Measurement measure)\n";
+        source += "                                          {\n";
+        for (auto &size_parameter : size_parameters)
+            source += "        int32_t param_" + size_parameter + " = tiralib::get_size(size, \"" + size_parameter + "\");\n";
+        std::stringstream allocation_lines(allocations);
+        std::string line;
+        while (std::getline(allocation_lines, line))
+            source += "    " + line + "\n";
+        std::string size_names;
+        for (auto &size_parameter : size_parameters)
+            size_names += (size_names.empty() ? "\"" : ", \"") + size_parameter + "\"";
+        for (auto buffer : buffers)
+        {
+            if (buffer->get_name() == "SIZES" && buffer->get_elements_type() == tiramisu::p_int32)
+                source += "        tiralib::set_size_values(buf_SIZES.raw(), size, {" + size_names + "});\n";
+        }
+        source += "        return measure([&]()\n";
+        source += "                       { return " + function_name + "(" + arguments + "); }); });\n";
+        source += "}\n";
+        return source;
+    }
+
+    source += allocations;
+    source += "    return tiralib::measure([&]()\n";
+    source += "                            { return " + function_name + "(" + arguments + "); });\n";
+    source += "}\n";
+    return source;
+}
+
+std::string generate_variants_wrapper_source(std::string function_name, std::vector<tiramisu::buffer *> buffers)
+{
+    std::string allocations, parameters, arguments;
+    std::set<std::string> size_parameters;
+    get_wrapper_buffers(buffers, allocations, parameters, arguments, size_parameters);
+    if (!size_parameters.empty())
+        throw std::invalid_argument("The variants of " + function_name + " need constant buffer sizes");
+
+    std::string source = "// Generated by TiraLibCPP from the buffers of " + function_name + ", the variants are given as arguments\n";
+    source += "#include <TiraLibCPP/wrapper_runtime.h>\n\n";
+    source += "typedef int (*kernel_type)(" + parameters + ");\n\n";
+    source += "int main(int argc, char *argv[])\n{\n";
+    source += allocations;
+    source += "    return tiralib::measure_variants(std::vector<std::string>(argv + 1, argv + argc), \"" + function_name + "\", [&](void *kernel)\n";
+    source += "                                     { return ((kernel_type)kernel)(" + arguments + "); });\n";
+    source += "}\n";
+    return source;
+}
+
+// the wrapper written for the function, from the database or from <function_name>_wrapper.cpp
+static bool prepare_own_wrapper(std::string function_name)
+{
+    if (file_exists(function_name + "_wrapper"))
+        return true;
+#ifdef USE_SQLITE
+    if (write_wrapper_from_db(function_name))
+    {
+        std::cout << "Error: could not write wrapper to file" << std::endl;
+        // exit with error
+        exit(1);
+    };
+    return true;
+#else
+    return compile_wrapper(function_name) == 0;
+#endif
+}
+
+static void compile_wrapper_source(std::string wrapper_name, std::string source, std::string libraries, std::string flags = "-O2")
+{
+    std::ofstream(wrapper_name + ".cpp") << source;
+    std::string compile_command = "c++ -std=c++17 " + flags + " " TIRALIBCPP_INCLUDE_DIRS " -I${TIRAMISU_ROOT}/include -I${TIRAMISU_ROOT}/3rdParty/Halide/install/include -L${TIRAMISU_ROOT}/build -L${TIRAMISU_ROOT}/3rdParty/Halide/install/lib64/ -L${TIRAMISU_ROOT}/3rdParty/isl/build/lib -o " + wrapper_name + " ./" + wrapper_name + ".cpp " + libraries + " -ltiramisu -lHalide -ldl -lpthread -fopenmp -lm -lisl -Wl,-rpath,${TIRAMISU_ROOT}/build";
+    int status = system(compile_command.c_str());
+    assert(status != 139 && "Segmentation Fault when trying to compile the wrapper");
+}
+
+// the wrapper only depends on the buffers, it is compiled once and reused with every new <function_name>.o.so
+static void prepare_builtin_wrapper(std::string function_name, std::vector<tiramisu::buffer *> buffers)
+{
+    std::string wrapper_name = function_name + "_tiralib_wrapper";
+    if (!file_exists(wrapper_name))
+        compile_wrapper_source(wrapper_name, generate_wrapper_source(function_name, buffers), "./" + function_name + ".o.so");
+}
+
+static bool write_file(std::string path, std::string content)
+{
+    std::ofstream file(path);
+    file << content;
+    file.flush();
+    return file.good();
+}
+
+static std::string to_cpu_list(const std::set<int> &ids)
+{
+    std::string list;
+    for (int id : ids)
+        list += (list.empty() ? "" : ",") + std::to_string(id);
+    return list;
+}
+
+// returns the cgroup.procs file of the slot's cgroup, or nothing when cgroup v2 or its cpuset controller are not available
+static std::string setup_slot_cgroup(std::string parent, int index, const std::vector<CPUInfo> &cpus)
+{
+    std::set<int> ids, nodes;
+    for (auto &cpu : cpus)
+    {
+        ids.insert(cpu.id);
+        nodes.insert(cpu.node);
+    }
+
+    // the controller is usually already enabled by whoever delegated the parent, this fails harmlessly then
+    write_file(parent + "/cgroup.subtree_control", "+cpuset");
+    std::string cgroup = parent + "/slot_" + std::to_string(index);
+    mkdir(cgroup.c_str(), 0755);
+    if (!write_file(cgroup + "/cpuset.cpus", to_cpu_list(ids)) || !write_file(cgroup + "/cpuset.mems", to_cpu_list(nodes)))
+        return "";
+    return cgroup + "/cgroup.procs";
+}
+
+MeasurementSlot::MeasurementSlot(const ExecutionOptions &options)
+{
+    auto allowed = get_allowed_cpus();
+    auto slots = partition_cpus(allowed, options.measurement_slots);
+    int nb_slots = slots.size();
+    mkdir(options.slot_lock_dir.c_str(), 0777);
+
+    auto get_lock_path = [&](int slot)
+    {
+        return options.slot_lock_dir + "/slot_" + std::to_string(nb_slots) + "_" + std::to_string(slot) + ".lock";
+    };
+    // processes start looking at different slots so that they rarely compete for the same lock
+    int first_slot = getpid() % nb_slots;
+    for (int i = 0; i < nb_slots && index == -1; i++)
+    {
+        int slot = (first_slot + i) % nb_slots;
+        int fd = open(get_lock_path(slot).c_str(), O_CREAT | O_RDWR, 0666);
+        if (fd != -1 && flock(fd, LOCK_EX | LOCK_NB) == 0)
+        {
+            lock_fd = fd;
+            index = slot;
+        }
+        else if (fd != -1)
+            close(fd);
+    }
+    if (index == -1)
+    {
+        lock_fd = open(get_lock_path(first_slot).c_str(), O_CREAT | O_RDWR, 0666);
+        if (lock_fd == -1 || flock(lock_fd, LOCK_EX) != 0)
+            throw std::runtime_error("Could not lock measurement slot " + get_lock_path(first_slot));
+        index = first_slot;
+    }
+
+    for (auto &cpu : allowed)
+    {
+        if (std::find(slots[index].begin(), slots[index].end(), cpu.id) != slots[index].end())
+            cpus.push_back(cpu);
+    }
+    if (!options.slot_cgroup.empty())
+        cgroup_procs = setup_slot_cgroup(options.slot_cgroup, index, cpus);
+}
+
+MeasurementSlot::~MeasurementSlot()
+{
+    // closing the file releases the lock
+    if (lock_fd != -1)
+        close(lock_fd);
+}
+
+WrapperPlacement MeasurementSlot::get_placement()
+{
+    WrapperPlacement placement;
+    placement.nb_threads = cpus.size();
+    for (auto &cpu : cpus)
+        placement.cpus.push_back(cpu.id);
+    placement.cgroup_procs = cgroup_procs;
+    return placement;
+}
+
+std::map<std::string, std::string> read_report(std::string report_path)
+{
+    std::map<std::string, std::string> report;
+    std::ifstream report_file(report_path);
+    std::string line;
+    while (std::getline(report_file, line))
+    {
+        size_t pos = line.find(' ');
+        if (pos != std::string::npos)
+            report[line.substr(0, pos)] = line.substr(pos + 1);
+    }
+    return report;
+}
+
+WrapperRun run_wrapper(std::string wrapper_path, const ExecutionOptions &options, const WrapperPlacement &placement, const std::vector<std::string> &arguments)
+{
+    char report_path[] = "/tmp/tiralib_report_XXXXXX";
+    int report_fd = mkstemp(report_path);
+    if (report_fd == -1)
+        throw std::runtime_error("Could not create the report file of the wrapper");
+    close(report_fd);
+
+    // the environment is built before forking, the child only calls async-signal-safe functions
+    std::map<std::string, std::string> variables = {
+        {"TIRAMISU_REPORT_FILE", report_path},
+        {"TIRAMISU_NB_EXEC", std::to_string(options.nb_exec)},
+        {"TIRAMISU_PERF_COUNTERS", options.perf_counters ? "1" : "0"},
+    };
+    if (!options.cache_mode.empty())
+        variables["TIRAMISU_CACHE_MODE"] = options.cache_mode;
+    variables["TIRAMISU_HUGEPAGES"] = options.hugepages;
+    variables["TIRAMISU_NUMA"] = options.numa;
+    variables["TIRAMISU_FILL"] = options.fill;
+    variables["TIRAMISU_FILL_SEED"] = std::to_string(options.fill_seed);
+    variables["TIRAMISU_PROBLEM_SIZES"] = options.problem_sizes;
+    variables["TIRAMISU_RECORD_REFERENCE"] = options.record_reference;
+    variables["TIRAMISU_VALIDATE_REFERENCE"] = options.validate_reference;
+    if (options.validation_rtol >= 0)
+        variables["TIRAMISU_VALIDATION_RTOL"] = std::to_string(options.validation_rtol);
+    if (options.validation_atol >= 0)
+        variables["TIRAMISU_VALIDATION_ATOL"] = std::to_string(options.validation_atol);
+    // Halide's thread pool and OpenMP
+    if (placement.nb_threads > 0)
+    {
+        variables["HL_NUM_THREADS"] = std::to_string(placement.nb_threads);
+        variables["OMP_NUM_THREADS"] = std::to_string(placement.nb_threads);
+    }
+    std::vector<std::string> environment;
+    for (char **variable = environ; *variable != NULL; variable++)
+    {
+        std::string name = std::string(*variable).substr(0, std::string(*variable).find('='));
+        if (variables.count(name) == 0)
+            environment.push_back(*variable);
+    }
+    for (auto &variable : variables)
+        environment.push_back(variable.first + "=" + variable.second);
+    std::vector<char *> envp;
+    for (auto &variable : environment)
+        envp.push_back(const_cast<char *>(variable.c_str()));
+    envp.push_back(NULL);
+    std::vector<char *> argv = {const_cast<char *>(wrapper_path.c_str())};
+    for (auto &argument : arguments)
+        argv.push_back(const_cast<char *>(argument.c_str()));
+    argv.push_back(NULL);
+    cpu_set_t affinity;
+    CPU_ZERO(&affinity);
+    for (int cpu : placement.cpus)
+        CPU_SET(cpu, &affinity);
+
+    int output_pipe[2];
+    if (pipe(output_pipe) == -1)
+        throw std::runtime_error("pipe() failed!");
+    pid_t pid = fork();
+    if (pid == -1)
+        throw std::runtime_error("fork() failed!");
+    if (pid == 0)
+    {
+        dup2(output_pipe[1], STDOUT_FILENO);
+        close(output_pipe[0]);
+        close(output_pipe[1]);
+        // "0" moves the writing process
+        if (!placement.cgroup_procs.empty())
+        {
+            int cgroup_fd = open(placement.cgroup_procs.c_str(), O_WRONLY);
+            if (cgroup_fd == -1 || write(cgroup_fd, "0", 1) != 1)
+                _exit(125);
+            close(cgroup_fd);
+        }
+        // the threads started by the wrapper inherit its affinity
+        if (!placement.cpus.empty() && sched_setaffinity(0, sizeof(affinity), &affinity) != 0)
+            _exit(126);
+        execve(argv[0], argv.data(), envp.data());
+        _exit(127);
+    }
+
+    close(output_pipe[1]);
+    WrapperRun run;
+    char buffer[128];
+    ssize_t nb_read;
+    while ((nb_read = read(output_pipe[0], buffer, sizeof(buffer))) > 0)
+        run.output.append(buffer, nb_read);
+    close(output_pipe[0]);
+
+    int status;
+    memset(&run.usage, 0, sizeof(run.usage));
+    wait4(pid, &status, 0, &run.usage);
+    run.success = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    run.report = read_report(report_path);
+    unlink(report_path);
+    return run;
+}
+
+void set_resource_usage(const WrapperRun &run, Result &result)
+{
+    // ru_maxrss is in kilobytes on Linux
+    result.max_rss_kb = run.usage.ru_maxrss;
+    result.minor_page_faults = run.usage.ru_minflt;
+    result.major_page_faults = run.usage.ru_majflt;
+    result.voluntary_context_switches = run.usage.ru_nvcsw;
+    result.involuntary_context_switches = run.usage.ru_nivcsw;
+    result.user_time = run.usage.ru_utime.tv_sec + run.usage.ru_utime.tv_usec / 1e6;
+    result.system_time = run.usage.ru_stime.tv_sec + run.usage.ru_stime.tv_usec / 1e6;
+}
+
+static double get_median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+template <typename T>
+static std::string to_json_list(const std::vector<T> &values)
+{
+    std::string json = "[";
+    for (size_t i = 0; i < values.size(); i++)
+        json += (i > 0 ? ", " : "") + std::to_string(values[i]);
+    return json + "]";
+}
+
+std::string run_thread_sweep(std::string wrapper_path, const ExecutionOptions &options, const std::vector<CPUInfo> &cpus, Result &result)
+{
+    std::vector<int> thread_counts = options.thread_counts;
+    std::sort(thread_counts.begin(), thread_counts.end());
+
+    std::string sweep = "[";
+    for (auto &policy : options.affinity_policies)
+    {
+        double base_time = 0;
+        int base_threads = 0;
+        for (int nb_threads : thread_counts)
+        {
+            std::string configuration = policy + ":" + std::to_string(nb_threads);
+            WrapperPlacement placement;
+            placement.nb_threads = nb_threads;
+            placement.cpus = get_affinity_cpus(cpus, nb_threads, policy);
+            if (placement.cpus.empty())
+            {
+                append_additional_info(result, "thread_sweep_skipped:" + configuration);
+                continue;
+            }
+
+            auto run = run_wrapper(wrapper_path, options, placement);
+            auto exec_times = parse_exec_times(run.report.count("exec_times") ? run.report["exec_times"] : run.output);
+            if (!run.success || exec_times.empty())
+            {
+                append_additional_info(result, "thread_sweep_failed:" + configuration);
+                continue;
+            }
+
+            double median = get_median(exec_times);
+            if (base_threads == 0)
+            {
+                base_time = median;
+                base_threads = nb_threads;
+            }
+            sweep += std::string(sweep.size() > 1 ? ", " : "") + "{\"threads\": " + std::to_string(nb_threads);
+            sweep += ", \"affinity\": \"" + policy + "\"";
+            sweep += ", \"cpus\": " + to_json_list(placement.cpus);
+            sweep += ", \"exec_times\": " + to_json_list(exec_times);
+            sweep += ", \"median\": " + std::to_string(median);
+            sweep += ", \"speedup\": " + std::to_string(base_time / median);
+            sweep += ", \"efficiency\": " + std::to_string(base_time * base_threads / (median * nb_threads)) + "}";
+        }
+    }
+    return sweep + "]";
+}
+
+std::string get_reference_path(std::string function_name, std::string function_hash, const ExecutionOptions &options)
+{
+    char *cache_dir = getenv("TIRAMISU_DEPS_CACHE_DIR");
+    std::string directory = cache_dir == NULL ? "." : cache_dir;
+    return directory + "/" + function_name + "_" + function_hash + "_reference_" + options.fill + "_" + std::to_string(options.fill_seed) + ".bin";
+}
+
+bool ensure_reference_output(std::string function_name, std::string function_hash, std::function<void(std::string)> run_unscheduled)
+{
+    ExecutionOptions options = get_execution_options();
+    std::string reference_path = get_reference_path(function_name, function_hash, options);
+    if (file_exists(reference_path))
+        return true;
+    // the unscheduled run itself
+    if (!options.record_reference.empty())
+        return false;
+
+    // concurrent evaluations of the same function may record it at the same time, the last rename wins
+    std::string recording_path = reference_path + "." + std::to_string(getpid()) + ".tmp";
+    recording_reference = recording_path;
+    run_unscheduled(recording_path);
+    recording_reference = "";
+    if (file_exists(recording_path))
+        rename(recording_path.c_str(), reference_path.c_str());
+    return file_exists(reference_path);
+}
+
+static void set_validation(WrapperRun &run, const ExecutionOptions &options, Result &result)
+{
+    if (run.report.count("output_checksum"))
+        result.output_checksum = run.report["output_checksum"];
+    if (run.report.count("validation_error"))
+        append_additional_info(result, "validation_error:" + run.report["validation_error"]);
+    if (options.validate_reference.empty() || !run.report.count("validation_passed"))
+        return;
+    result.validated = true;
+    result.validation_passed = run.report["validation_passed"] == "1";
+    result.validation_max_abs_error = std::stod(run.report["validation_max_abs_error"]);
+    result.validation_max_rel_error = std::stod(run.report["validation_max_rel_error"]);
+    if (!result.validation_passed)
+        append_additional_info(result, "validation_nb_errors:" + run.report["validation_nb_errors"]);
+}
+
+// JSON array with the times of every problem size of a parametric function, the fields of the result that have
+// a single value get the ones of the first size
+static std::string get_problem_size_results(WrapperRun &run)
+{
+    std::string results = "[";
+    int nb_sizes = std::stoi(run.report["nb_problem_sizes"]);
+    for (int i = 0; i < nb_sizes; i++)
+    {
+        std::string prefix = "size_" + std::to_string(i) + "_";
+        auto exec_times = parse_exec_times(run.report[prefix + "exec_times"]);
+        results += std::string(i > 0 ? ", " : "") + "{\"size\": \"" + run.report[prefix + "problem_size"] + "\"";
+        results += ", \"exec_times\": " + to_json_list(exec_times);
+        results += ", \"median\": " + std::to_string(exec_times.empty() ? 0 : get_median(exec_times));
+        results += ", \"success\": " + std::string(exec_times.empty() || run.report.count(prefix + "error") ? "false" : "true") + "}";
+    }
+    for (auto key : {"exec_times", "perf_counters", "allocation", "cache_mode", "cache_flush_bytes"})
+    {
+        if (run.report.count("size_0_" + std::string(key)))
+            run.report[key] = run.report["size_0_" + std::string(key)];
+    }
+    return results + "]";
+}
+
+MachinePeaks get_machine_peaks()
+{
+    static MachinePeaks peaks;
+    static bool measured = false;
+    if (measured)
+        return peaks;
+    measured = true;
+
+    char hostname[256] = "";
+    gethostname(hostname, sizeof(hostname) - 1);
+    char *cache_dir = getenv("TIRAMISU_DEPS_CACHE_DIR");
+    std::string directory = cache_dir == NULL ? "." : cache_dir;
+    std::string peaks_path = directory + "/tiralib_machine_peaks_" + hostname + ".txt";
+    auto report = read_report(peaks_path);
+    if (!report.count("peak_gflops") || !report.count("peak_bandwidth"))
+    {
+        // the benchmark is compiled for the machine so that it uses its widest vectors
+        std::string benchmark_name = "tiralib_machine_peaks";
+        if (!file_exists(benchmark_name))
+            compile_wrapper_source(benchmark_name, "#include <TiraLibCPP/wrapper_runtime.h>\n\nint main() { return tiralib::measure_machine_peaks(); }\n", "", "-O3 -march=native");
+        auto run = run_wrapper("./" + benchmark_name, ExecutionOptions());
+        report = run.report;
+        if (!run.success || !report.count("peak_gflops") || !report.count("peak_bandwidth"))
+            return peaks;
+        std::string recording_path = peaks_path + "." + std::to_string(getpid()) + ".tmp";
+        if (write_file(recording_path, "peak_gflops " + report["peak_gflops"] + "\npeak_bandwidth " + report["peak_bandwidth"] + "\n"))
+            rename(recording_path.c_str(), peaks_path.c_str());
+    }
+    peaks.gflops = std::stod(report["peak_gflops"]);
+    peaks.bandwidth = std::stod(report["peak_bandwidth"]);
+    return peaks;
+}
+
+// operations and compulsory traffic of the implicit function, and the rates achieved by the median execution time
+static void set_roofline(const std::vector<double> &exec_times, Result &result)
+{
+    OperationCounts counts = get_operation_counts(tiramisu::global::get_implicit_function());
+    result.flops = counts.operations;
+    result.compulsory_bytes = counts.compulsory_bytes;
+    result.operation_counts = operation_counts_to_json(counts);
+    if (counts.compulsory_bytes > 0)
+        result.arithmetic_intensity = counts.operations / counts.compulsory_bytes;
+    if (!counts.exact)
+        append_additional_info(result, "roofline_approximate");
+    if (!exec_times.empty())
+    {
+        // the times are in milliseconds
+        double seconds = get_median(exec_times) / 1e3;
+        result.achieved_gflops = counts.operations / seconds / 1e9;
+        result.achieved_bandwidth = counts.compulsory_bytes / seconds / 1e9;
+    }
+    MachinePeaks peaks = get_machine_peaks();
+    result.peak_gflops = peaks.gflops;
+    result.peak_bandwidth = peaks.bandwidth;
+    if (peaks.gflops == 0)
+        append_additional_info(result, "machine_peaks_unavailable");
+}
+
+void execute_function(std::string function_name, std::string function_hash, std::vector<tiramisu::buffer *> buffers, Result &result)
+{
+    ExecutionOptions options = get_execution_options();
+    bool parametric = is_parametric(buffers);
+    if (parametric && options.problem_sizes.empty())
+        append_additional_info(result, "problem_sizes_missing");
+    // the outputs of the problem sizes have different sizes, they are not validated
+    if (parametric && options.validate)
+    {
+        options.validate = false;
+        append_additional_info(result, "validation_unsupported:problem_sizes");
+    }
+    // the reference is recorded before the code of the scheduled function is generated, see ensure_reference_output
+    if (options.validate && options.record_reference.empty())
+    {
+        if (file_exists(get_reference_path(function_name, function_hash, options)))
+            options.validate_reference = get_reference_path(function_name, function_hash, options);
+        else
+            append_additional_info(result, "validation_reference_missing");
+    }
+    tiramisu::codegen(buffers, function_name + ".o");
+
+    std::string gpp_command = "g++";
+    std::string gcc_cmd = gpp_command + " -shared -o " + function_name + ".o.so " + function_name + ".o";
+    // run the command and retrieve the execution status
+    int status = system(gcc_cmd.c_str());
+    assert(status != 139 && "Segmentation Fault when trying to execute schedule");
+
+    // the measurements beyond the execution times and the allocation options need the wrapper runtime
+    bool needs_runtime = options.perf_counters || !options.cache_mode.empty() || options.hugepages != "none" || options.numa != "default" || options.fill != "random" || options.fill_seed != 0 || options.validate || !options.record_reference.empty() || parametric;
+    std::string wrapper_path = "./" + function_name + "_wrapper";
+    if (options.builtin_wrapper || needs_runtime || !prepare_own_wrapper(function_name))
+    {
+        prepare_builtin_wrapper(function_name, buffers);
+        wrapper_path = "./" + function_name + "_tiralib_wrapper";
+    }
+
+    // concurrent measurements stay on the CPUs of their slot
+    std::unique_ptr<MeasurementSlot> slot;
+    WrapperPlacement placement;
+    if (options.measurement_slots > 0)
+    {
+        slot = std::make_unique<MeasurementSlot>(options);
+        placement = slot->get_placement();
+        result.measurement_slot = slot->index;
+        if (!options.slot_cgroup.empty() && slot->cgroup_procs.empty())
+            append_additional_info(result, "slot_cgroup_unavailable");
+    }
+
+    auto run = run_wrapper(wrapper_path, options, placement);
+    result.success = run.success;
+    set_resource_usage(run, result);
+    if (run.report.count("nb_problem_sizes"))
+        result.problem_sizes = get_problem_size_results(run);
+    // wrappers written by hand only print their execution times
+    result.exec_times = run.report.count("exec_times") ? run.report["exec_times"] : run.output;
+    // remove new line character
+    if (!result.exec_times.empty() && result.exec_times[result.exec_times.length() - 1] == '\n')
+    {
+        result.exec_times.erase(result.exec_times.length() - 1);
+    }
+
+    if (run.report.count("perf_counters"))
+        result.perf_counters = run.report["perf_counters"];
+    if (options.perf_counters && result.perf_counters == "[]")
+        append_additional_info(result, "perf_counters_unavailable");
+    if (run.report.count("allocation"))
+        result.allocation = run.report["allocation"];
+    if (run.report.count("cache_mode"))
+        result.cache_mode = run.report["cache_mode"];
+    if (run.report.count("cache_flush_bytes"))
+        append_additional_info(result, "cache_flush_bytes:" + run.report["cache_flush_bytes"]);
+    set_validation(run, options, result);
+
+    // the domains of a parametric function have no size until a problem size is chosen
+    if (result.success && options.roofline && parametric)
+        append_additional_info(result, "roofline_unsupported:problem_sizes");
+    else if (result.success && options.roofline)
+        set_roofline(parse_exec_times(result.exec_times), result);
+
+    // the sweep reuses the compiled schedule and wrapper
+    if (result.success && !options.thread_counts.empty() && parametric)
+        append_additional_info(result, "thread_sweep_skipped:problem_sizes");
+    else if (result.success && !options.thread_counts.empty())
+        result.thread_sweep = run_thread_sweep(wrapper_path, options, slot ? slot->cpus : get_allowed_cpus(), result);
+}
+
+void generate_variant(std::string function_name, std::string variant_name, std::vector<tiramisu::buffer *> buffers)
+{
+    tiramisu::codegen(buffers, variant_name + ".o");
+    // the variants wrapper only depends on the buffers and loads the variants at run time
+    std::string wrapper_name = function_name + "_tiralib_variants_wrapper";
+    if (!file_exists(wrapper_name))
+        compile_wrapper_source(wrapper_name, generate_variants_wrapper_source(function_name, buffers), "");
+}
+
+void link_variants(std::vector<std::string> variant_names, int nb_jobs)
+{
+    if (nb_jobs <= 0)
+        nb_jobs = std::max(1u, std::thread::hardware_concurrency());
+    std::atomic<size_t> next_variant(0);
+    std::vector<std::thread> jobs;
+    for (int job = 0; job < nb_jobs; job++)
+    {
+        jobs.emplace_back([&]()
+                          {
+                              for (size_t i = next_variant++; i < variant_names.size(); i = next_variant++)
+                              {
+                                  std::string command = "g++ -shared -o " + variant_names[i] + ".o.so " + variant_names[i] + ".o";
+                                  system(command.c_str());
+                              } });
+    }
+    for (auto &job : jobs)
+        job.join();
+}
+
+std::vector<std::vector<double>> execute_variants(std::string function_name, std::vector<std::string> variant_names, Result &result)
+{
+    ExecutionOptions options = get_execution_options();
+    std::unique_ptr<MeasurementSlot> slot;
+    WrapperPlacement placement;
+    if (options.measurement_slots > 0)
+    {
+        slot = std::make_unique<MeasurementSlot>(options);
+        placement = slot->get_placement();
+        result.measurement_slot = slot->index;
+    }
+
+    // dlopen only looks for paths with a slash in the working directory
+    std::vector<std::string> libraries;
+    for (auto &variant_name : variant_names)
+        libraries.push_back("./" + variant_name + ".o.so");
+    auto run = run_wrapper("./" + function_name + "_tiralib_variants_wrapper", options, placement, libraries);
+    result.success = run.success;
+    set_resource_usage(run, result);
+
+    std::vector<std::vector<double>> exec_times;
+    for (size_t i = 0; i < variant_names.size(); i++)
+    {
+        std::string prefix = "variant_" + std::to_string(i) + "_";
+        if (run.report.count(prefix + "error"))
+            append_additional_info(result, prefix + "error:" + run.report[prefix + "error"]);
+        exec_times.push_back(parse_exec_times(run.report[prefix + "exec_times"]));
+    }
+    return exec_times;
+}
@@ -0,0 +1,73 @@
+#include <tiramisu/tiramisu.h>
+#include <TiraLibCPP/actions.h>
+#include <TiraLibCPP/dependency_snapshot.h>
+#include <TiraLibCPP/execution.h>
+#include <TiraLibCPP/function_loader.h>
+
+#include <dlfcn.h>
+
+function_builder load_function_builder(std::string library_path, std::string function_name)
+{
+    void *library = dlopen(library_path.c_str(), RTLD_NOW | RTLD_GLOBAL);
+    if (library == nullptr)
+        throw std::runtime_error("Could not load " + library_path + ": " + dlerror());
+
+    // the library stays loaded for the lifetime of the process
+    std::string symbol_name = "build_" + function_name;
+    auto builder = (function_builder)dlsym(library, symbol_name.c_str());
+    if (builder == nullptr)
+        throw std::invalid_argument("No symbol " + symbol_name + " in " + library_path);
+    return builder;
+}
+
+Result builder_schedule_str_to_result(std::string function_name, function_builder builder, std::string schedule_str, Operation operation)
+{
+    Result result;
+    // the builder defines the function again, without schedule, to record the reference outputs
+    if (operation == Operation::execution && get_execution_options().validate)
+    {
+        // the reference is keyed by the program, which only exists once the builder has declared it
+        std::string function_hash;
+        builder([&](std::vector<tiramisu::buffer *> buffers)
+                {
+                    tiramisu::prepare_schedules_for_legality_checks();
+                    function_hash = get_function_source_hash(tiramisu::global::get_implicit_function()); });
+        ensure_reference_output(function_name, function_hash, [&](std::string recording_path)
+                                { builder([&](std::vector<tiramisu::buffer *> buffers)
+                                          { schedule_str_to_result(function_name, "", operation, buffers); }); });
+    }
+    builder([&](std::vector<tiramisu::buffer *> buffers)
+            { result = schedule_str_to_result(function_name, schedule_str, operation, buffers); });
+    return result;
+}
+
+std::vector<Result> builder_schedule_strs_to_predictions(std::string function_name, function_builder builder, std::vector<std::string> schedule_strs)
+{
+    std::vector<Result> results;
+    std::vector<std::string> prediction_inputs;
+    std::vector<size_t> predicted;
+    for (auto &schedule_str : schedule_strs)
+    {
+        std::string prediction_input;
+        builder([&](std::vector<tiramisu::buffer *> buffers)
+                { results.push_back(schedule_str_to_result(function_name, schedule_str, Operation::prediction, buffers, &prediction_input)); });
+        if (!prediction_input.empty())
+        {
+            prediction_inputs.push_back(prediction_input);
+            predicted.push_back(results.size() - 1);
+        }
+    }
+
+    auto speedups = predict_speedups(prediction_inputs);
+    for (size_t i = 0; i < predicted.size(); i++)
+        results[predicted[i]].predicted_speedup = speedups[i];
+    return results;
+}
+
+std::string builder_get_program_annotations(function_builder builder)
+{
+    std::string annotations;
+    builder([&](std::vector<tiramisu::buffer *> buffers)
+            { annotations = get_program_annotations(tiramisu::global::get_implicit_function()); });
+    return annotations;
+}
@@ -0,0 +1,212 @@
+#include <tiramisu/tiramisu.h>
+#include <TiraLibCPP/roofline.h>
+
+#include <isl/map.h>
+
+#include <map>
+
+int count_operations(const tiramisu::expr &e)
+{
+    if (e.get_expr_type() != tiramisu::e_op)
+        return 0;
+    // the indices of an access are address computations
+    if (e.get_op_type() == tiramisu::o_access || e.get_op_type() == tiramisu::o_buffer || e.get_op_type() == tiramisu::o_allocate)
+        return 0;
+
+    int operations = 0;
+    switch (e.get_op_type())
+    {
+    case tiramisu::o_add:
+    case tiramisu::o_sub:
+    case tiramisu::o_mul:
+    case tiramisu::o_div:
+    case tiramisu::o_mod:
+    case tiramisu::o_minus:
+    case tiramisu::o_max:
+    case tiramisu::o_min:
+    case tiramisu::o_sqrt:
+    case tiramisu::o_expo:
+    case tiramisu::o_log:
+    case tiramisu::o_floor:
+    case tiramisu::o_ceil:
+    case tiramisu::o_round:
+    case tiramisu::o_abs:
+        operations = 1;
+        break;
+    default:
+        break;
+    }
+    for (int i = 0; i < e.get_n_arg(); i++)
+        operations += count_operations(e.get_operand(i));
+    return operations;
+}
+
+double count_points(isl_set *set, bool &exact, double max_points)
+{
+    if (isl_set_is_empty(set) == isl_bool_true)
+        return 0;
+
+    double box_points = 1;
+    int n_dims = isl_set_dim(set, isl_dim_set);
+    for (int dim = 0; dim < n_dims; dim++)
+    {
+        isl_val *max = isl_set_dim_max_val(isl_set_copy(set), dim);
+        isl_val *min = isl_set_dim_min_val(isl_set_copy(set), dim);
+        bool bounded = isl_val_is_int(max) == isl_bool_true && isl_val_is_int(min) == isl_bool_true;
+        if (bounded)
+            box_points *= isl_val_get_d(max) - isl_val_get_d(min) + 1;
+        isl_val_free(max);
+        isl_val_free(min);
+        if (!bounded)
+            throw std::invalid_argument("Cannot count the points of an unbounded set");
+    }
+
+    if (box_points > max_points)
+    {
+        exact = false;
+        return box_points;
+    }
+    isl_val *count = isl_set_count_val(set);
+    double points = isl_val_get_d(count);
+    isl_val_free(count);
+    return points;
+}
+
+static int get_element_size(tiramisu::primitive_t type)
+{
+    switch (type)
+    {
+    case tiramisu::p_uint8:
+    case tiramisu::p_int8:
+    case tiramisu::p_boolean:
+        return 1;
+    case tiramisu::p_uint16:
+    case tiramisu::p_int16:
+        return 2;
+    case tiramisu::p_uint32:
+    case tiramisu::p_int32:
+    case tiramisu::p_float32:
+        return 4;
+    default:
+        return 8;
+    }
+}
+
+// elements of every buffer accessed by the domain through the access relations (maps to buffer elements)
+static void add_footprints(isl_set *domain, std::vector<isl_map *> accesses, std::map<std::string, isl_set *> &footprints)
+{
+    for (auto access : accesses)
+    {
+        std::string buffer_name = isl_map_get_tuple_name(access, isl_dim_out);
+        isl_set *elements = isl_set_apply(isl_set_copy(domain), access);
+        if (footprints.count(buffer_name))
+            footprints[buffer_name] = isl_set_union(footprints[buffer_name], elements);
+        else
+            footprints[buffer_name] = elements;
+    }
+}
+
+// total bytes of the footprints, which are freed
+static double get_footprint_bytes(std::map<std::string, isl_set *> &footprints, tiramisu::function *implicit_function, bool &exact)
+{
+    auto &buffers = implicit_function->get_buffers();
+    double bytes = 0;
+    for (auto &footprint : footprints)
+    {
+        int element_size = buffers.count(footprint.first) ? get_element_size(buffers.at(footprint.first)->get_elements_type()) : 8;
+        bytes += count_points(footprint.second, exact) * element_size;
+        isl_set_free(footprint.second);
+    }
+    footprints.clear();
+    return bytes;
+}
+
+OperationCounts get_operation_counts(tiramisu::function *implicit_function)
+{
+    OperationCounts counts;
+    std::map<std::string, isl_set *> function_reads, function_writes;
+    for (auto comp : implicit_function->get_computations())
+    {
+        // inputs have no expression, they are only read
+        if (comp->get_expr().get_expr_type() == tiramisu::e_none || comp->get_access_relation() == nullptr)
+            continue;
+
+        ComputationCounts comp_counts;
+        comp_counts.name = comp->get_name();
+        isl_set *domain = comp->get_iteration_domain();
+        comp_counts.points = count_points(domain, comp_counts.exact);
+        comp_counts.operations = count_operations(comp->get_expr()) * comp_counts.points;
+
+        // the accesses to other computations go through the buffers these computations are stored in
+        std::vector<isl_map *> accesses, reads;
+        tiramisu::generator::get_rhs_accesses(implicit_function, comp, accesses, false);
+        for (auto access : accesses)
+        {
+            // computations split into several parts with the same name share their buffer
+            auto producers = implicit_function->get_computation_by_name(isl_map_get_tuple_name(access, isl_dim_out));
+            if (!producers.empty() && producers[0]->get_access_relation() != nullptr)
+                reads.push_back(isl_map_apply_range(access, isl_map_copy(producers[0]->get_access_relation())));
+            else
+                isl_map_free(access);
+        }
+        std::vector<isl_map *> writes = {isl_map_copy(comp->get_access_relation())};
+
+        std::map<std::string, isl_set *> comp_reads, comp_writes;
+        for (auto read : reads)
+            add_footprints(domain, {isl_map_copy(read)}, comp_reads);
+        add_footprints(domain, {isl_map_copy(writes[0])}, comp_writes);
+        comp_counts.bytes_read = get_footprint_bytes(comp_reads, implicit_function, comp_counts.exact);
+        comp_counts.bytes_written = get_footprint_bytes(comp_writes, implicit_function, comp_counts.exact);
+        // the elements the function wrote before are not loaded again, their store is already counted
+        std::map<std::string, isl_set *> new_reads;
+        add_footprints(domain, reads, new_reads);
+        for (auto &read : new_reads)
+        {
+            if (function_writes.count(read.first))
+                read.second = isl_set_subtract(read.second, isl_set_copy(function_writes[read.first]));
+            if (function_reads.count(read.first))
+                function_reads[read.first] = isl_set_union(function_reads[read.first], read.second);
+            else
+                function_reads[read.first] = read.second;
+        }
+        add_footprints(domain, writes, function_writes);
+
+        counts.operations += comp_counts.operations;
+        counts.exact &= comp_counts.exact;
+        counts.computations.push_back(comp_counts);
+    }
+    // temporary buffers are produced and consumed by the function, they are not part of its compulsory traffic
+    auto &buffers = implicit_function->get_buffers();
+    for (auto footprints : {&function_reads, &function_writes})
+    {
+        for (auto footprint = footprints->begin(); footprint != footprints->end();)
+        {
+            if (buffers.count(footprint->first) && buffers.at(footprint->first)->get_argument_type() == tiramisu::a_temporary)
+            {
+                isl_set_free(footprint->second);
+                footprint = footprints->erase(footprint);
+            }
+            else
+                footprint++;
+        }
+    }
+    counts.compulsory_bytes = get_footprint_bytes(function_reads, implicit_function, counts.exact);
+    counts.compulsory_bytes += get_footprint_bytes(function_writes, implicit_function, counts.exact);
+    return counts;
+}
+
+std::string operation_counts_to_json(const OperationCounts &counts)
+{
+    std::string json = "[";
+    for (size_t i = 0; i < counts.computations.size(); i++)
+    {
+        auto &comp = counts.computations[i];
+        json += std::string(i > 0 ? ", " : "") + "{\"name\": \"" + comp.name + "\"";
+        json += ", \"points\": " + std::to_string((long long)comp.points);
+        json += ", \"operations\": " + std::to_string((long long)comp.operations);
+        json += ", \"bytes_read\": " + std::to_string((long long)comp.bytes_read);
+        json += ", \"bytes_written\": " + std::to_string((long long)comp.bytes_written);
+        json += ", \"exact\": " + std::string(comp.exact ? "true" : "false") + "}";
+    }
+    return json + "]";
+}
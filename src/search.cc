@@ -0,0 +1,454 @@
+#include <tiramisu/tiramisu.h>
+#include <TiraLibCPP/actions.h>
+#include <TiraLibCPP/canonicalization.h>
+#include <TiraLibCPP/execution.h>
+#include <TiraLibCPP/search.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <random>
+
+cost_function make_execution_cost(std::string function_name, function_builder builder)
+{
+    return [function_name, builder](std::string schedule_str, Result &result)
+    {
+        result = builder_schedule_str_to_result(function_name, builder, schedule_str, Operation::execution);
+        auto exec_times = parse_exec_times(result.exec_times);
+        if (!result.legality || !result.success || exec_times.empty())
+            return std::numeric_limits<double>::infinity();
+
+        std::sort(exec_times.begin(), exec_times.end());
+        return exec_times[exec_times.size() / 2];
+    };
+}
+
+cost_function make_prediction_cost(std::string function_name, function_builder builder)
+{
+    return [function_name, builder](std::string schedule_str, Result &result)
+    {
+        result = builder_schedule_str_to_result(function_name, builder, schedule_str, Operation::prediction);
+        if (!result.legality || result.predicted_speedup <= 0)
+            return std::numeric_limits<double>::infinity();
+        return 1 / result.predicted_speedup;
+    };
+}
+
+static int get_schedule_depth(std::string schedule_str)
+{
+    if (schedule_str.empty())
+        return 0;
+    return std::count(schedule_str.begin(), schedule_str.end(), '|') + 1;
+}
+
+struct MCTSNode
+{
+    std::string schedule_str;
+    MCTSNode *parent = nullptr;
+    std::vector<std::unique_ptr<MCTSNode>> children;
+    std::vector<std::string> untried;
+    bool expanded = false;
+    int visits = 0;
+    double total_reward = 0;
+};
+
+class ScheduleSearch
+{
+public:
+    ScheduleSearch(std::string function_name, function_builder builder, SearchConfig config, cost_function cost)
+        : function_name(function_name), builder(builder), config(config), cost(cost), rng(config.seed),
+          start(std::chrono::steady_clock::now())
+    {
+    }
+
+    std::vector<SearchResult> run()
+    {
+        baseline_cost = evaluate("");
+        if (config.method == "beam")
+            beam_search();
+        else if (config.method == "mcts")
+            mcts();
+        else
+            throw std::invalid_argument("Unknown search method " + config.method);
+
+        std::vector<SearchResult> results;
+        for (auto &evaluation : evaluations)
+        {
+            if (std::isfinite(evaluation.second.cost))
+                results.push_back(evaluation.second);
+        }
+        // ties are broken by the schedule so that the same seed always gives the same results
+        std::sort(results.begin(), results.end(), [](const SearchResult &a, const SearchResult &b)
+                  { return a.cost < b.cost || (a.cost == b.cost && a.schedule_str < b.schedule_str); });
+        if ((int)results.size() > config.nb_results)
+            results.resize(config.nb_results);
+        return results;
+    }
+
+private:
+    bool budget_exhausted()
+    {
+        if (config.max_executions > 0 && nb_executions >= config.max_executions)
+            return true;
+        if (config.time_budget > 0)
+        {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            return elapsed.count() >= config.time_budget;
+        }
+        return false;
+    }
+
+    // canonical schedules that extend the prefix with one candidate action, their legality is cached on the way
+    std::vector<std::string> get_children(std::string prefix)
+    {
+        auto mask = get_legal_actions_mask(function_name, builder, prefix, config.menu);
+
+        std::vector<std::string> children;
+        for (size_t i = 0; i < mask.actions.size(); i++)
+        {
+            std::string child = canonicalize_schedule_str(prefix.empty() ? mask.actions[i] : prefix + "|" + mask.actions[i]);
+            // actions that cancel a previous one lead back to a shorter schedule
+            if (get_schedule_depth(child) > get_schedule_depth(prefix))
+            {
+                legality_cache.insert({child, mask.legal[i]});
+                children.push_back(child);
+            }
+        }
+        return children;
+    }
+
+    bool is_legal(std::string schedule_str)
+    {
+        auto legality = legality_cache.find(schedule_str);
+        if (legality != legality_cache.end())
+            return legality->second;
+
+        bool legal;
+        try
+        {
+            legal = builder_schedule_str_to_result(function_name, builder, schedule_str, Operation::legality).legality;
+        }
+        catch (std::exception &e)
+        {
+            legal = false;
+        }
+        legality_cache[schedule_str] = legal;
+        return legal;
+    }
+
+    double evaluate(std::string schedule_str)
+    {
+        auto evaluation = evaluations.find(schedule_str);
+        if (evaluation != evaluations.end())
+            return evaluation->second.cost;
+
+        SearchResult search_result = {.schedule_str = schedule_str};
+        search_result.cost = cost(schedule_str, search_result.result);
+        nb_executions++;
+        evaluations[schedule_str] = search_result;
+        return search_result.cost;
+    }
+
+    void beam_search()
+    {
+        std::vector<std::string> beam = {""};
+        for (int depth = 0; depth < config.max_depth && !beam.empty() && !budget_exhausted(); depth++)
+        {
+            std::vector<std::pair<double, std::string>> scored_children;
+            for (auto &schedule_str : beam)
+            {
+                for (auto &child : get_children(schedule_str))
+                {
+                    if (budget_exhausted())
+                        break;
+                    if (evaluations.count(child) || !is_legal(child))
+                        continue;
+                    double child_cost = evaluate(child);
+                    if (std::isfinite(child_cost))
+                        scored_children.push_back({child_cost, child});
+                }
+            }
+
+            std::sort(scored_children.begin(), scored_children.end());
+            beam.clear();
+            for (int i = 0; i < (int)scored_children.size() && i < config.beam_size; i++)
+                beam.push_back(scored_children[i].second);
+        }
+    }
+
+    // speedup over the initial schedule
+    double get_reward(double schedule_cost)
+    {
+        if (!std::isfinite(schedule_cost) || !std::isfinite(baseline_cost) || schedule_cost <= 0)
+            return 0;
+        return baseline_cost / schedule_cost;
+    }
+
+    MCTSNode *select_child(MCTSNode *node)
+    {
+        MCTSNode *best_child = nullptr;
+        double best_score = -std::numeric_limits<double>::infinity();
+        for (auto &child : node->children)
+        {
+            double score = child->visits == 0 ? std::numeric_limits<double>::infinity()
+                                              : child->total_reward / child->visits + config.mcts_exploration * std::sqrt(std::log(node->visits) / child->visits);
+            if (score > best_score)
+            {
+                best_score = score;
+                best_child = child.get();
+            }
+        }
+        return best_child;
+    }
+
+    void expand(MCTSNode *node)
+    {
+        node->expanded = true;
+        if (get_schedule_depth(node->schedule_str) >= config.max_depth)
+            return;
+        node->untried = get_children(node->schedule_str);
+        std::shuffle(node->untried.begin(), node->untried.end(), rng);
+    }
+
+    // extends the schedule with random legal actions up to a random depth
+    std::string rollout(std::string schedule_str)
+    {
+        int max_depth = std::uniform_int_distribution<int>(get_schedule_depth(schedule_str), config.max_depth)(rng);
+        while (get_schedule_depth(schedule_str) < max_depth)
+        {
+            auto children = get_children(schedule_str);
+            std::shuffle(children.begin(), children.end(), rng);
+            auto legal_child = std::find_if(children.begin(), children.end(), [this](std::string &child)
+                                            { return is_legal(child); });
+            if (legal_child == children.end())
+                break;
+            schedule_str = *legal_child;
+        }
+        return schedule_str;
+    }
+
+    void mcts()
+    {
+        MCTSNode root;
+        for (int iteration = 0; iteration < config.mcts_iterations && !budget_exhausted(); iteration++)
+        {
+            MCTSNode *node = &root;
+            while (node->expanded && node->untried.empty() && !node->children.empty())
+                node = select_child(node);
+
+            if (!node->expanded)
+                expand(node);
+            while (!node->untried.empty())
+            {
+                std::string child = node->untried.back();
+                node->untried.pop_back();
+                if (!is_legal(child))
+                    continue;
+                node->children.push_back(std::make_unique<MCTSNode>());
+                node->children.back()->schedule_str = child;
+                node->children.back()->parent = node;
+                node = node->children.back().get();
+                break;
+            }
+
+            double reward = get_reward(evaluate(rollout(node->schedule_str)));
+            for (; node != nullptr; node = node->parent)
+            {
+                node->visits++;
+                node->total_reward += reward;
+            }
+        }
+    }
+
+    std::string function_name;
+    function_builder builder;
+    SearchConfig config;
+    cost_function cost;
+    std::mt19937_64 rng;
+    std::chrono::steady_clock::time_point start;
+    double baseline_cost;
+    int nb_executions = 0;
+    std::map<std::string, bool> legality_cache;
+    std::map<std::string, SearchResult> evaluations;
+};
+
+std::vector<SearchResult> search_schedules(std::string function_name, function_builder builder, SearchConfig config, cost_function cost)
+{
+    if (cost == nullptr)
+        cost = make_execution_cost(function_name, builder);
+    return ScheduleSearch(function_name, builder, config, cost).run();
+}
+
+std::string instantiate_schedule_template(std::string schedule_template, const std::map<std::string, int> &values)
+{
+    std::string schedule_str;
+    for (size_t i = 0; i < schedule_template.size(); i++)
+    {
+        if (schedule_template[i] != '$')
+        {
+            schedule_str += schedule_template[i];
+            continue;
+        }
+        size_t end = i + 1;
+        while (end < schedule_template.size() && (std::isalnum(schedule_template[end]) || schedule_template[end] == '_'))
+            end++;
+        std::string name = schedule_template.substr(i + 1, end - i - 1);
+        if (values.count(name) == 0)
+            throw std::invalid_argument("No value for parameter $" + name);
+        schedule_str += std::to_string(values.at(name));
+        i = end - 1;
+    }
+    return schedule_str;
+}
+
+std::vector<std::map<std::string, int>> get_parameter_grid(const std::map<std::string, std::vector<int>> &parameters)
+{
+    std::vector<std::map<std::string, int>> grid = {{}};
+    for (auto &parameter : parameters)
+    {
+        std::vector<std::map<std::string, int>> extended;
+        for (auto &point : grid)
+        {
+            for (int value : parameter.second)
+            {
+                extended.push_back(point);
+                extended.back()[parameter.first] = value;
+            }
+        }
+        grid = extended;
+    }
+    return grid;
+}
+
+class ParameterSweep
+{
+public:
+    ParameterSweep(std::string function_name, function_builder builder, std::string schedule_template, ParameterSweepConfig config)
+        : function_name(function_name), builder(builder), schedule_template(schedule_template), config(config) {}
+
+    ParameterSweepResult run()
+    {
+        for (auto &parameter : config.parameters)
+        {
+            if (parameter.second.empty())
+                throw std::invalid_argument("No value for parameter $" + parameter.first);
+        }
+
+        if (config.method == "grid")
+            measure(get_parameter_grid(config.parameters));
+        else if (config.method == "coordinate")
+            coordinate_search();
+        else
+            throw std::invalid_argument("Unknown sweep method " + config.method);
+
+        for (size_t i = 0; i < result.points.size(); i++)
+        {
+            if (result.points[i].median != std::numeric_limits<double>::infinity() && (result.best == -1 || result.points[i].median < result.points[result.best].median))
+                result.best = i;
+        }
+        return result;
+    }
+
+private:
+    void coordinate_search()
+    {
+        std::map<std::string, int> best_values;
+        for (auto &parameter : config.parameters)
+            best_values[parameter.first] = parameter.second[0];
+        measure({best_values});
+        double best_median = get_point(best_values).median;
+
+        for (int round = 0; round < config.max_rounds; round++)
+        {
+            bool improved = false;
+            for (auto &parameter : config.parameters)
+            {
+                std::vector<std::map<std::string, int>> line;
+                for (int value : parameter.second)
+                {
+                    line.push_back(best_values);
+                    line.back()[parameter.first] = value;
+                }
+                measure(line);
+                for (auto &values : line)
+                {
+                    if (get_point(values).median < best_median)
+                    {
+                        best_median = get_point(values).median;
+                        best_values = values;
+                        improved = true;
+                    }
+                }
+            }
+            if (!improved)
+                break;
+        }
+    }
+
+    const ParameterPoint &get_point(const std::map<std::string, int> &values)
+    {
+        return result.points[point_indices.at(values)];
+    }
+
+    // compiles and times the points that were not measured yet as one batch of variants
+    void measure(std::vector<std::map<std::string, int>> points)
+    {
+        std::vector<int> batch;
+        std::vector<std::string> variant_names;
+        for (auto &values : points)
+        {
+            if (point_indices.count(values))
+                continue;
+            ParameterPoint point;
+            point.values = values;
+            point.schedule_str = instantiate_schedule_template(schedule_template, values);
+            point.median = std::numeric_limits<double>::infinity();
+
+            std::string variant_name = function_name + "_variant_" + std::to_string(result.points.size());
+            builder([&](std::vector<tiramisu::buffer *> buffers)
+                    {
+                        point.legality = schedule_str_to_result(function_name, point.schedule_str, Operation::legality, buffers).legality;
+                        if (point.legality)
+                            generate_variant(function_name, variant_name, buffers); });
+
+            point_indices[values] = result.points.size();
+            if (point.legality)
+            {
+                batch.push_back(result.points.size());
+                variant_names.push_back(variant_name);
+            }
+            result.points.push_back(point);
+        }
+        if (batch.empty())
+            return;
+
+        link_variants(variant_names, config.compile_jobs);
+        Result execution;
+        auto exec_times = execute_variants(function_name, variant_names, execution);
+        for (size_t i = 0; i < batch.size(); i++)
+        {
+            auto &point = result.points[batch[i]];
+            point.exec_times = exec_times[i];
+            if (!point.exec_times.empty())
+            {
+                std::vector<double> sorted = point.exec_times;
+                std::sort(sorted.begin(), sorted.end());
+                point.median = sorted[sorted.size() / 2];
+            }
+        }
+    }
+
+    std::string function_name;
+    function_builder builder;
+    std::string schedule_template;
+    ParameterSweepConfig config;
+    ParameterSweepResult result;
+    std::map<std::map<std::string, int>, int> point_indices;
+};
+
+ParameterSweepResult sweep_schedule_parameters(std::string function_name, function_builder builder, std::string schedule_template, ParameterSweepConfig config)
+{
+    return ParameterSweep(function_name, builder, schedule_template, config).run();
+}
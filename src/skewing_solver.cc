@@ -0,0 +1,106 @@
+#include <tiramisu/tiramisu.h>
+#include <TiraLibCPP/action_space.h>
+#include <TiraLibCPP/skewing_solver.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+
+static std::map<std::string, std::string> in_process_candidates;
+
+static std::string factors_to_json(const std::vector<std::pair<int, int>> &factors)
+{
+    std::string json = "[";
+    for (size_t i = 0; i < factors.size(); i++)
+    {
+        json += (i > 0 ? ", [" : "[") + std::to_string(factors[i].first) + ", " + std::to_string(factors[i].second) + "]";
+    }
+    return json + "]";
+}
+
+static std::string solve_to_json(std::vector<tiramisu::computation *> comps, int level, tiramisu::function *implicit_function)
+{
+    auto solutions = implicit_function->skewing_local_solver(comps, level, level + 1, 1);
+
+    std::string json = "{\"comps\": [";
+    for (size_t i = 0; i < comps.size(); i++)
+        json += (i > 0 ? ", \"" : "\"") + comps[i]->get_name() + "\"";
+    json += "], \"levels\": [" + std::to_string(level) + ", " + std::to_string(level + 1) + "]";
+    json += ", \"outer_parallelism\": " + factors_to_json(std::get<0>(solutions));
+    json += ", \"inner_parallelism\": " + factors_to_json(std::get<1>(solutions));
+    json += ", \"locality\": " + factors_to_json(std::get<2>(solutions));
+    return json + "}";
+}
+
+static std::string get_cache_path(std::string function_name)
+{
+    char *cache_dir = getenv("TIRAMISU_DEPS_CACHE_DIR");
+    if (cache_dir == NULL)
+        return "";
+    return std::string(cache_dir) + "/" + function_name + "_skewing.txt";
+}
+
+// one "<hash>\t<schedule>\t<candidates>" line per solved schedule
+static bool load_cached_candidates(std::string cache_path, std::string key, std::string &candidates)
+{
+    std::ifstream cache_file(cache_path);
+    std::string line;
+    while (std::getline(cache_file, line))
+    {
+        size_t pos = line.rfind('\t');
+        if (pos != std::string::npos && line.substr(0, pos) == key)
+        {
+            candidates = line.substr(pos + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string get_skewing_candidates(std::string function_name, std::string function_hash, std::string schedule_str, tiramisu::function *implicit_function)
+{
+    std::string key = function_hash + "\t" + schedule_str;
+    auto cached = in_process_candidates.find(key);
+    if (cached != in_process_candidates.end())
+        return cached->second;
+
+    std::string cache_path = get_cache_path(function_name);
+    std::string candidates;
+    if (!cache_path.empty() && load_cached_candidates(cache_path, key, candidates))
+    {
+        in_process_candidates[key] = candidates;
+        return candidates;
+    }
+
+    tiramisu::prepare_schedules_for_legality_checks(true);
+    std::vector<std::string> solutions;
+    for (auto &loop_nest : get_loop_nests(implicit_function))
+    {
+        int shared_depth = get_shared_depth(loop_nest);
+        for (int level = 0; level + 1 < shared_depth; level++)
+            solutions.push_back(solve_to_json(loop_nest, level, implicit_function));
+
+        // the levels below the shared ones belong to a single computation
+        for (auto comp : loop_nest)
+        {
+            if (loop_nest.size() == 1)
+                break;
+            for (int level = std::max(shared_depth - 1, 0); level + 1 < comp->get_loop_levels_number(); level++)
+                solutions.push_back(solve_to_json({comp}, level, implicit_function));
+        }
+    }
+
+    candidates = "[";
+    for (size_t i = 0; i < solutions.size(); i++)
+        candidates += (i > 0 ? ", " : "") + solutions[i];
+    candidates += "]";
+
+    in_process_candidates[key] = candidates;
+    if (!cache_path.empty())
+    {
+        // a single appended line, concurrent writers at worst solve the same schedule twice
+        std::ofstream cache_file(cache_path, std::ios::app);
+        cache_file << key << "\t" << candidates << "\n";
+    }
+    return candidates;
+}
@@ -0,0 +1,79 @@
+#include <TiraLibCPP/work_queue.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Command line front-end of the shared-filesystem work queue:
+//   tiralib_queue submit <queue_dir> <items_file>              one "function_name<TAB>operation<TAB>schedule" per line
+//   tiralib_queue worker <queue_dir> <executables_dir> [worker_id] [--wait]
+//   tiralib_queue coordinator <queue_dir> [lease_seconds]
+//   tiralib_queue collect <queue_dir>                          prints one JSON result per line
+
+static int usage()
+{
+    std::cerr << "Usage: tiralib_queue submit <queue_dir> <items_file>" << std::endl;
+    std::cerr << "       tiralib_queue worker <queue_dir> <executables_dir> [worker_id] [--wait]" << std::endl;
+    std::cerr << "       tiralib_queue coordinator <queue_dir> [lease_seconds]" << std::endl;
+    std::cerr << "       tiralib_queue collect <queue_dir>" << std::endl;
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+        return usage();
+
+    std::string command = argv[1];
+    std::string queue_dir = argv[2];
+
+    if (command == "submit" && argc == 4)
+    {
+        std::ifstream items_file(argv[3]);
+        std::vector<WorkItem> items;
+        std::string line;
+        while (std::getline(items_file, line))
+        {
+            size_t first_tab = line.find('\t');
+            size_t second_tab = line.find('\t', first_tab + 1);
+            if (first_tab == std::string::npos || second_tab == std::string::npos)
+                continue;
+            WorkItem item;
+            item.function_name = line.substr(0, first_tab);
+            item.operation = line.substr(first_tab + 1, second_tab - first_tab - 1);
+            item.schedule_str = line.substr(second_tab + 1);
+            items.push_back(item);
+        }
+        int nb_queued = submit_work_items(queue_dir, items);
+        std::cout << "Queued " << nb_queued << " of " << items.size() << " items" << std::endl;
+        return 0;
+    }
+    else if (command == "worker" && argc >= 4)
+    {
+        WorkerConfig config;
+        config.executables_dir = argv[3];
+        for (int i = 4; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--wait") == 0)
+                config.wait_for_work = true;
+            else
+                config.worker_id = argv[i];
+        }
+        run_worker(queue_dir, config);
+        return 0;
+    }
+    else if (command == "coordinator")
+    {
+        int lease_seconds = argc >= 4 ? std::stoi(argv[3]) : 300;
+        run_coordinator(queue_dir, lease_seconds);
+        return 0;
+    }
+    else if (command == "collect")
+    {
+        for (auto &result : collect_work_results(queue_dir))
+            std::cout << result << std::endl;
+        return 0;
+    }
+
+    return usage();
+}
@@ -1,5 +1,7 @@
 #include <tiramisu/tiramisu.h>
 #include <TiraLibCPP/utils.h>
+#include <algorithm>
+#include <sstream>
 // #include "function_floyd_warshall_MINI_wrapper.h"
 
 using namespace tiramisu;
@@ -28,12 +30,46 @@ tiramisu::computation *get_computation_by_name(std::string comp_name, tiramisu::
     }
 }
 
+int get_loop_extent(tiramisu::computation *comp, int level)
+{
+    isl_set *time_space = isl_set_apply(isl_set_copy(comp->get_iteration_domain()), isl_map_copy(comp->get_schedule()));
+    int dim = tiramisu::loop_level_into_dynamic_dimension(level);
+    isl_val *max = isl_set_dim_max_val(isl_set_copy(time_space), dim);
+    isl_val *min = isl_set_dim_min_val(time_space, dim);
+
+    // non-constant bounds (e.g. after skewing) have no single extent
+    int extent = -1;
+    if (isl_val_is_int(max) && isl_val_is_int(min))
+        extent = isl_val_get_num_si(max) - isl_val_get_num_si(min) + 1;
+    isl_val_free(max);
+    isl_val_free(min);
+    return extent;
+}
+
 // String Parsing Helpers
 bool isSingleQuoteOrWhiteSpace(char c)
 {
     return (c == '\'' || std::isspace(c));
 }
 
+// FNV-1a is used instead of std::hash so that hashes are stable across processes and builds
+uint64_t fnv1a_hash(const std::string &str, uint64_t hash)
+{
+    for (unsigned char c : str)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string hash_to_str(uint64_t hash)
+{
+    std::stringstream ss;
+    ss << std::hex << hash;
+    return ss.str();
+}
+
 std::string get_first_comp(std::string comps_str)
 {
     std::string delimiter = ",";
@@ -68,10 +104,33 @@ Operation get_operation_from_string(std::string operation_str)
         return Operation::execution;
     else if (operation_str == "annotations")
         return Operation::annotations;
+    else if (operation_str == "prediction")
+        return Operation::prediction;
+    else if (operation_str == "skewing_solver")
+        return Operation::skewing_solver;
     else
         assert(false && "Unknown operation");
 }
 
+std::string get_string_from_operation(Operation operation)
+{
+    switch (operation)
+    {
+    case Operation::legality:
+        return "legality";
+    case Operation::execution:
+        return "execution";
+    case Operation::annotations:
+        return "annotations";
+    case Operation::skewing_solver:
+        return "skewing_solver";
+    case Operation::prediction:
+        return "prediction";
+    }
+    assert(false && "Unknown operation");
+    return "";
+}
+
 // Compile and Exec Helpers
 bool file_exists(const std::string &name)
 {
@@ -104,6 +163,20 @@ std::tuple<bool, std::string> exec(const char *cmd)
     return std::make_tuple(rc == 0, result);
 }
 
+std::string shell_quote(std::string str)
+{
+    std::string quoted = "'";
+    for (char c : str)
+    {
+        if (c == '\'')
+            quoted += "'\\''";
+        else
+            quoted += c;
+    }
+    quoted += "'";
+    return quoted;
+}
+
 int compile_wrapper(std::string function_name)
 {
     if (file_exists(function_name + "_wrapper.cpp"))
@@ -119,6 +192,33 @@ int compile_wrapper(std::string function_name)
 }
 
 // Serialization Helpers
+void append_additional_info(Result &result, std::string info)
+{
+    if (!result.additional_info.empty())
+        result.additional_info += ";";
+    result.additional_info += info;
+}
+
+// the wrapper prints the execution times separated by spaces (or commas)
+std::vector<double> parse_exec_times(std::string exec_times)
+{
+    std::replace(exec_times.begin(), exec_times.end(), ',', ' ');
+    std::vector<double> times;
+    std::stringstream ss(exec_times);
+    double time;
+    while (ss >> time)
+        times.push_back(time);
+    return times;
+}
+
+// keeps the significant digits of small values that std::to_string rounds to 0
+static std::string to_precise_string(double value)
+{
+    std::ostringstream ss;
+    ss << value;
+    return ss.str();
+}
+
 std::string serialize_result(Result &result)
 {
     std::string result_str = "{";
@@ -127,7 +227,134 @@ std::string serialize_result(Result &result)
     result_str += "\"isl_ast\": \"" + result.isl_ast + "\",";
     result_str += "\"exec_times\": \"" + result.exec_times + "\",";
     result_str += "\"success\": " + std::to_string(result.success) + ",";
+    result_str += "\"predicted_speedup\": " + std::to_string(result.predicted_speedup) + ",";
+    result_str += "\"skewing_candidates\": " + result.skewing_candidates + ",";
+    result_str += "\"perf_counters\": " + result.perf_counters + ",";
+    result_str += "\"thread_sweep\": " + result.thread_sweep + ",";
+    result_str += "\"problem_sizes\": " + result.problem_sizes + ",";
+    result_str += "\"measurement_slot\": " + std::to_string(result.measurement_slot) + ",";
+    result_str += "\"cache_mode\": \"" + result.cache_mode + "\",";
+    result_str += "\"allocation\": \"" + result.allocation + "\",";
+    result_str += "\"validated\": " + std::to_string(result.validated) + ",";
+    result_str += "\"validation_passed\": " + std::to_string(result.validation_passed) + ",";
+    result_str += "\"validation_max_abs_error\": " + to_precise_string(result.validation_max_abs_error) + ",";
+    result_str += "\"validation_max_rel_error\": " + to_precise_string(result.validation_max_rel_error) + ",";
+    result_str += "\"output_checksum\": \"" + result.output_checksum + "\",";
+    result_str += "\"flops\": " + to_precise_string(result.flops) + ",";
+    result_str += "\"compulsory_bytes\": " + to_precise_string(result.compulsory_bytes) + ",";
+    result_str += "\"arithmetic_intensity\": " + to_precise_string(result.arithmetic_intensity) + ",";
+    result_str += "\"achieved_gflops\": " + to_precise_string(result.achieved_gflops) + ",";
+    result_str += "\"achieved_bandwidth\": " + to_precise_string(result.achieved_bandwidth) + ",";
+    result_str += "\"peak_gflops\": " + to_precise_string(result.peak_gflops) + ",";
+    result_str += "\"peak_bandwidth\": " + to_precise_string(result.peak_bandwidth) + ",";
+    result_str += "\"operation_counts\": " + result.operation_counts + ",";
+    result_str += "\"max_rss_kb\": " + std::to_string(result.max_rss_kb) + ",";
+    result_str += "\"minor_page_faults\": " + std::to_string(result.minor_page_faults) + ",";
+    result_str += "\"major_page_faults\": " + std::to_string(result.major_page_faults) + ",";
+    result_str += "\"voluntary_context_switches\": " + std::to_string(result.voluntary_context_switches) + ",";
+    result_str += "\"involuntary_context_switches\": " + std::to_string(result.involuntary_context_switches) + ",";
+    result_str += "\"user_time\": " + std::to_string(result.user_time) + ",";
+    result_str += "\"system_time\": " + std::to_string(result.system_time) + ",";
     result_str += "\"additional_info\": \"" + result.additional_info + "\"";
     result_str += "}";
     return result_str;
 }
+
+// Returns the raw text of a field written by serialize_result, string values are returned without their quotes.
+// Strings are not escaped by serialize_result, so a string value ends at the first quote followed by the next key or the closing brace.
+std::string get_serialized_field(const std::string &result_str, std::string key)
+{
+    std::string key_str = "\"" + key + "\": ";
+    size_t pos = result_str.find(key_str);
+    if (pos == std::string::npos)
+        return "";
+    pos += key_str.size();
+
+    if (result_str[pos] == '"')
+    {
+        for (size_t end = pos + 1; end < result_str.size(); end++)
+        {
+            if (result_str[end] == '"' && (result_str.compare(end + 1, 2, ",\"") == 0 || result_str.compare(end + 1, 1, "}") == 0))
+                return result_str.substr(pos + 1, end - pos - 1);
+        }
+        return "";
+    }
+
+    int depth = 0;
+    size_t end = pos;
+    for (; end < result_str.size(); end++)
+    {
+        char c = result_str[end];
+        if (c == '[' || c == '{')
+            depth++;
+        else if ((c == ']' || c == '}') && depth > 0)
+            depth--;
+        else if ((c == ',' || c == '}') && depth == 0)
+            break;
+    }
+    return result_str.substr(pos, end - pos);
+}
+
+// leaves the value unchanged when the field is missing (results serialized by older versions)
+template <typename T>
+static void read_number_field(const std::string &result_str, std::string key, T &value)
+{
+    std::string field = get_serialized_field(result_str, key);
+    if (!field.empty())
+        value = (T)std::stod(field);
+}
+
+Result deserialize_result(std::string result_str)
+{
+    Result result = {
+        .name = get_serialized_field(result_str, "name"),
+        .legality = get_serialized_field(result_str, "legality") == "1",
+        .isl_ast = get_serialized_field(result_str, "isl_ast"),
+        .exec_times = get_serialized_field(result_str, "exec_times"),
+        .additional_info = get_serialized_field(result_str, "additional_info"),
+        .success = get_serialized_field(result_str, "success") == "1",
+    };
+    std::string predicted_speedup = get_serialized_field(result_str, "predicted_speedup");
+    if (!predicted_speedup.empty())
+        result.predicted_speedup = std::stod(predicted_speedup);
+    std::string skewing_candidates = get_serialized_field(result_str, "skewing_candidates");
+    if (!skewing_candidates.empty())
+        result.skewing_candidates = skewing_candidates;
+    std::string perf_counters = get_serialized_field(result_str, "perf_counters");
+    if (!perf_counters.empty())
+        result.perf_counters = perf_counters;
+    std::string thread_sweep = get_serialized_field(result_str, "thread_sweep");
+    if (!thread_sweep.empty())
+        result.thread_sweep = thread_sweep;
+    std::string problem_sizes = get_serialized_field(result_str, "problem_sizes");
+    if (!problem_sizes.empty())
+        result.problem_sizes = problem_sizes;
+    std::string measurement_slot = get_serialized_field(result_str, "measurement_slot");
+    if (!measurement_slot.empty())
+        result.measurement_slot = std::stoi(measurement_slot);
+    result.cache_mode = get_serialized_field(result_str, "cache_mode");
+    result.allocation = get_serialized_field(result_str, "allocation");
+    read_number_field(result_str, "validated", result.validated);
+    read_number_field(result_str, "validation_passed", result.validation_passed);
+    read_number_field(result_str, "validation_max_abs_error", result.validation_max_abs_error);
+    read_number_field(result_str, "validation_max_rel_error", result.validation_max_rel_error);
+    result.output_checksum = get_serialized_field(result_str, "output_checksum");
+    read_number_field(result_str, "flops", result.flops);
+    read_number_field(result_str, "compulsory_bytes", result.compulsory_bytes);
+    read_number_field(result_str, "arithmetic_intensity", result.arithmetic_intensity);
+    read_number_field(result_str, "achieved_gflops", result.achieved_gflops);
+    read_number_field(result_str, "achieved_bandwidth", result.achieved_bandwidth);
+    read_number_field(result_str, "peak_gflops", result.peak_gflops);
+    read_number_field(result_str, "peak_bandwidth", result.peak_bandwidth);
+    std::string operation_counts = get_serialized_field(result_str, "operation_counts");
+    if (!operation_counts.empty())
+        result.operation_counts = operation_counts;
+    read_number_field(result_str, "max_rss_kb", result.max_rss_kb);
+    read_number_field(result_str, "minor_page_faults", result.minor_page_faults);
+    read_number_field(result_str, "major_page_faults", result.major_page_faults);
+    read_number_field(result_str, "voluntary_context_switches", result.voluntary_context_switches);
+    read_number_field(result_str, "involuntary_context_switches", result.involuntary_context_switches);
+    read_number_field(result_str, "user_time", result.user_time);
+    read_number_field(result_str, "system_time", result.system_time);
+    return result;
+}
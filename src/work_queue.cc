@@ -0,0 +1,393 @@
+#include <TiraLibCPP/utils.h>
+#include <TiraLibCPP/work_queue.h>
+
+#include <atomic>
+#include <cerrno>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// Workers of several nodes share the queue directory, so their pids alone are not unique
+static std::string get_default_worker_id()
+{
+    char hostname[256] = "";
+    gethostname(hostname, sizeof(hostname) - 1);
+    return std::string(hostname) + "-" + std::to_string(getpid());
+}
+
+// File Helpers
+static bool read_work_item(std::string path, WorkItem &item)
+{
+    std::ifstream item_file(path);
+    if (!item_file.is_open())
+        return false;
+    std::getline(item_file, item.id);
+    std::getline(item_file, item.function_name);
+    std::getline(item_file, item.operation);
+    std::getline(item_file, item.schedule_str);
+    return !item.id.empty();
+}
+
+// write the file next to its destination and rename it so that readers never see a partial item
+static bool write_work_item(std::string path, WorkItem &item)
+{
+    std::string tmp_path = path + ".tmp." + get_default_worker_id();
+    std::ofstream item_file(tmp_path);
+    if (!item_file.is_open())
+        return false;
+    item_file << item.id << "\n"
+              << item.function_name << "\n"
+              << item.operation << "\n"
+              << item.schedule_str << "\n";
+    item_file.close();
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+static bool is_tmp_file(const std::string &file_name)
+{
+    return file_name.find(".tmp.") != std::string::npos;
+}
+
+static void touch(std::string path)
+{
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+}
+
+static double seconds_since_last_write(std::string path)
+{
+    std::error_code ec;
+    auto last_write = fs::last_write_time(path, ec);
+    if (ec)
+        return 0;
+    return std::chrono::duration<double>(fs::file_time_type::clock::now() - last_write).count();
+}
+
+// claim files are named <id>.<worker_id>
+static std::string get_claim_item_id(const std::string &claim_name)
+{
+    return claim_name.substr(0, claim_name.find('.'));
+}
+
+static std::vector<std::string> list_files(std::string dir)
+{
+    std::vector<std::string> files;
+    std::error_code ec;
+    for (auto &entry : fs::directory_iterator(dir, ec))
+    {
+        std::string file_name = entry.path().filename().string();
+        if (!is_tmp_file(file_name))
+            files.push_back(file_name);
+    }
+    return files;
+}
+
+static int count_claims(std::string queue_dir, std::string item_id)
+{
+    int nb_claims = 0;
+    for (auto &claim_name : list_files(queue_dir + "/claimed"))
+    {
+        if (get_claim_item_id(claim_name) == item_id)
+            nb_claims++;
+    }
+    return nb_claims;
+}
+
+static std::string escape_json_str(std::string str)
+{
+    std::string escaped;
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+// Queue Operations
+std::string get_work_item_id(std::string function_name, std::string operation, std::string schedule_str)
+{
+    return hash_to_str(fnv1a_hash(function_name + "\n" + operation + "\n" + schedule_str));
+}
+
+void init_work_queue(std::string queue_dir)
+{
+    fs::create_directories(queue_dir + "/pending");
+    fs::create_directories(queue_dir + "/claimed");
+    fs::create_directories(queue_dir + "/results");
+}
+
+int submit_work_items(std::string queue_dir, std::vector<WorkItem> items)
+{
+    init_work_queue(queue_dir);
+    int nb_queued = 0;
+    for (auto &item : items)
+    {
+        if (item.id.empty())
+            item.id = get_work_item_id(item.function_name, item.operation, item.schedule_str);
+
+        // resubmitting a batch after a crash only queues the items that were lost
+        if (file_exists(queue_dir + "/results/" + item.id) || file_exists(queue_dir + "/pending/" + item.id) || count_claims(queue_dir, item.id) > 0)
+            continue;
+
+        if (write_work_item(queue_dir + "/pending/" + item.id, item))
+            nb_queued++;
+    }
+    return nb_queued;
+}
+
+bool claim_work_item(std::string queue_dir, WorkerConfig &config, WorkItem &item)
+{
+    for (auto &item_id : list_files(queue_dir + "/pending"))
+    {
+        std::string claim_path = queue_dir + "/claimed/" + item_id + "." + config.worker_id;
+        // the mtime of the pending item is its submission time, it becomes the first heartbeat before the claim
+        // is visible so that requeue_expired_work_items never sees a fresh claim as expired
+        touch(queue_dir + "/pending/" + item_id);
+        // only one worker can win the rename of a pending item
+        if (std::rename((queue_dir + "/pending/" + item_id).c_str(), claim_path.c_str()) != 0)
+            continue;
+        if (read_work_item(claim_path, item))
+            return true;
+    }
+
+    // work stealing: re-execute items whose single owner stopped making progress, the first commit wins
+    for (auto &claim_name : list_files(queue_dir + "/claimed"))
+    {
+        std::string item_id = get_claim_item_id(claim_name);
+        std::string claim_path = queue_dir + "/claimed/" + claim_name;
+        if (file_exists(queue_dir + "/results/" + item_id) || count_claims(queue_dir, item_id) > 1)
+            continue;
+        if (claim_name == item_id + "." + config.worker_id || seconds_since_last_write(claim_path) < config.straggler_seconds)
+            continue;
+        if (!read_work_item(claim_path, item))
+            continue;
+        if (write_work_item(queue_dir + "/claimed/" + item_id + "." + config.worker_id, item))
+            return true;
+    }
+    return false;
+}
+
+bool commit_work_result(std::string queue_dir, std::string worker_id, std::string item_id, std::string result_str)
+{
+    std::string result_path = queue_dir + "/results/" + item_id;
+    std::string tmp_path = result_path + ".tmp." + worker_id;
+    std::ofstream result_file(tmp_path);
+    result_file << result_str << "\n";
+    result_file.close();
+
+    // link fails if the result already exists, which makes commits idempotent
+    bool committed = link(tmp_path.c_str(), result_path.c_str()) == 0;
+    unlink(tmp_path.c_str());
+
+    // the claims of the original owner and of the thieves are all settled by this result
+    for (auto &claim_name : list_files(queue_dir + "/claimed"))
+    {
+        if (get_claim_item_id(claim_name) == item_id)
+            unlink((queue_dir + "/claimed/" + claim_name).c_str());
+    }
+    return committed;
+}
+
+int requeue_expired_work_items(std::string queue_dir, int lease_seconds)
+{
+    int nb_requeued = 0;
+    for (auto &claim_name : list_files(queue_dir + "/claimed"))
+    {
+        std::string item_id = get_claim_item_id(claim_name);
+        std::string claim_path = queue_dir + "/claimed/" + claim_name;
+        if (file_exists(queue_dir + "/results/" + item_id))
+        {
+            // left behind by a worker that lost the race to commit
+            unlink(claim_path.c_str());
+            continue;
+        }
+        if (seconds_since_last_write(claim_path) < lease_seconds)
+            continue;
+
+        if (count_claims(queue_dir, item_id) > 1)
+        {
+            // another worker is still evaluating this item
+            unlink(claim_path.c_str());
+        }
+        else if (std::rename(claim_path.c_str(), (queue_dir + "/pending/" + item_id).c_str()) == 0)
+        {
+            nb_requeued++;
+        }
+    }
+    return nb_requeued;
+}
+
+bool work_queue_is_done(std::string queue_dir)
+{
+    return list_files(queue_dir + "/pending").empty() && list_files(queue_dir + "/claimed").empty();
+}
+
+std::vector<std::string> collect_work_results(std::string queue_dir)
+{
+    std::vector<std::string> results;
+    for (auto &item_id : list_files(queue_dir + "/results"))
+    {
+        std::ifstream result_file(queue_dir + "/results/" + item_id);
+        std::string line;
+        if (std::getline(result_file, line))
+            results.push_back(line);
+    }
+    return results;
+}
+
+// Worker and Coordinator Loops
+
+// Runs the executable and returns whether it exited with status 0, its standard output is stored in output. Its process
+// group is killed after timeout_seconds (never when 0), timed_out is then set.
+static bool run_executable(std::vector<std::string> arguments, int timeout_seconds, std::string &output, bool &timed_out)
+{
+    std::vector<char *> argv;
+    for (auto &argument : arguments)
+        argv.push_back(const_cast<char *>(argument.c_str()));
+    argv.push_back(nullptr);
+
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0)
+        throw std::runtime_error("pipe() failed!");
+    pid_t pid = fork();
+    if (pid < 0)
+        throw std::runtime_error("fork() failed!");
+    if (pid == 0)
+    {
+        // the compilers and wrappers started by the executable are killed with it
+        setpgid(0, 0);
+        dup2(fds[1], STDOUT_FILENO);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    close(fds[1]);
+    setpgid(pid, pid);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeout_seconds);
+    timed_out = false;
+    char buffer[4096];
+    while (true)
+    {
+        int wait_ms = -1;
+        if (timeout_seconds > 0)
+        {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0)
+            {
+                timed_out = true;
+                break;
+            }
+            wait_ms = remaining;
+        }
+        pollfd output_fd = {fds[0], POLLIN, 0};
+        int nb_ready = poll(&output_fd, 1, wait_ms);
+        if (nb_ready < 0 && errno == EINTR)
+            continue;
+        if (nb_ready == 0)
+            continue;
+        ssize_t nb_read = read(fds[0], buffer, sizeof(buffer));
+        if (nb_read < 0 && errno == EINTR)
+            continue;
+        if (nb_read <= 0)
+            break;
+        output.append(buffer, nb_read);
+    }
+    close(fds[0]);
+
+    if (timed_out)
+        kill(-pid, SIGKILL);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return !timed_out && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static std::string evaluate_work_item(WorkItem &item, WorkerConfig &config)
+{
+    std::string output;
+    bool timed_out = false;
+    bool success = run_executable({config.executables_dir + "/" + item.function_name, item.operation, item.schedule_str},
+                                  config.evaluation_timeout_seconds, output, timed_out);
+
+    // the serialized result is the last line printed by the generated executable
+    while (!output.empty() && output.back() == '\n')
+        output.pop_back();
+    std::string result_str = output.substr(output.rfind('\n') == std::string::npos ? 0 : output.rfind('\n') + 1);
+
+    // a timed out item gets a result too, so that its claim is released and no other worker runs it again
+    if (!success || result_str.empty() || result_str[0] != '{')
+    {
+        Result result = {
+            .name = item.function_name,
+            .legality = false,
+            .exec_times = "",
+            .additional_info = timed_out ? "evaluation_timeout" : "worker_error",
+            .success = false,
+        };
+        result_str = serialize_result(result);
+    }
+
+    return "{\"id\": \"" + item.id + "\", \"function_name\": \"" + item.function_name + "\", \"operation\": \"" + item.operation + "\", \"schedule\": \"" + escape_json_str(item.schedule_str) + "\", \"result\": " + result_str + "}";
+}
+
+static void heartbeat_loop(std::string claim_path, int heartbeat_seconds, std::atomic<bool> *running)
+{
+    auto last_heartbeat = std::chrono::steady_clock::now();
+    while (*running)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (std::chrono::steady_clock::now() - last_heartbeat >= std::chrono::seconds(heartbeat_seconds))
+        {
+            touch(claim_path);
+            last_heartbeat = std::chrono::steady_clock::now();
+        }
+    }
+}
+
+void run_worker(std::string queue_dir, WorkerConfig config)
+{
+    if (config.worker_id.empty())
+        config.worker_id = get_default_worker_id();
+
+    while (true)
+    {
+        WorkItem item;
+        if (!claim_work_item(queue_dir, config, item))
+        {
+            if (!config.wait_for_work && work_queue_is_done(queue_dir))
+                break;
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            continue;
+        }
+
+        std::string claim_path = queue_dir + "/claimed/" + item.id + "." + config.worker_id;
+        std::atomic<bool> running(true);
+        std::thread heartbeat(heartbeat_loop, claim_path, config.heartbeat_seconds, &running);
+
+        std::string result_str = evaluate_work_item(item, config);
+
+        running = false;
+        heartbeat.join();
+        commit_work_result(queue_dir, config.worker_id, item.id, result_str);
+    }
+}
+
+void run_coordinator(std::string queue_dir, int lease_seconds)
+{
+    init_work_queue(queue_dir);
+    while (!work_queue_is_done(queue_dir))
+    {
+        int nb_requeued = requeue_expired_work_items(queue_dir, lease_seconds);
+        if (nb_requeued > 0)
+            std::cerr << "Requeued " << nb_requeued << " items from lost workers" << std::endl;
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
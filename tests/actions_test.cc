@@ -225,9 +225,9 @@ TEST(TiraLibCppTest, Tiling2D)
             clean_halide_ir(halide_ir));
 }
 
-TEST(TiraLibCppTest, Tiling3D)
+TEST(TiraLibCppTest, TilingGeneralized)
 {
-  std::string schedule = "T3(L0,L1,L2,32,32,32,comps=['comp_blur'])";
+  std::string schedule = "T(levels=[L0,L1],factors=[32,32],comps=['comp_blur'])";
   auto result = apply_schedule_blur(schedule);
 
   Result resultInstance = std::get<0>(result);
@@ -271,16 +271,17 @@ TEST(TiraLibCppTest, Tiling3D)
   // -------------------------------------------------------
   // Code Generation
   // -------------------------------------------------------
-  comp_blur.tile(0, 1, 2, 32, 32, 32);
+  comp_blur.tile(0, 1, 32, 32);
 
+  EXPECT_EQ(resultInstance.legality, true);
   EXPECT_EQ(global::get_implicit_function()->get_name(), function_name);
   EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
             clean_halide_ir(halide_ir));
 }
 
-TEST(TiraLibCppTest, Unrolling)
+TEST(TiraLibCppTest, TilingMultiLevel)
 {
-  std::string schedule = "U(L2,32,comps=['comp_blur'])";
+  std::string schedule = "T(levels=[L1,L2],factors=[16,16,4,4],comps=['comp_blur'])";
   auto result = apply_schedule_blur(schedule);
 
   Result resultInstance = std::get<0>(result);
@@ -324,16 +325,18 @@ TEST(TiraLibCppTest, Unrolling)
   // -------------------------------------------------------
   // Code Generation
   // -------------------------------------------------------
-  comp_blur.unroll(2, 32);
+  comp_blur.tile(1, 2, 16, 16);
+  comp_blur.tile(3, 4, 4, 4);
 
+  EXPECT_EQ(resultInstance.legality, true);
   EXPECT_EQ(global::get_implicit_function()->get_name(), function_name);
   EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
             clean_halide_ir(halide_ir));
 }
 
-TEST(TiraLibCppTest, Interchange)
+TEST(TiraLibCppTest, TilingParallelOuterTiles)
 {
-  std::string schedule = "I(L0,L1,comps=['comp_blur'])";
+  std::string schedule = "T(levels=[L1,L2],factors=[8,8],parallel=1,comps=['comp_blur'])";
   auto result = apply_schedule_blur(schedule);
 
   Result resultInstance = std::get<0>(result);
@@ -377,36 +380,31 @@ TEST(TiraLibCppTest, Interchange)
   // -------------------------------------------------------
   // Code Generation
   // -------------------------------------------------------
-  comp_blur.interchange(0, 1);
+  comp_blur.tile(1, 2, 8, 8);
+  comp_blur.tag_parallel_level(1);
 
+  EXPECT_EQ(resultInstance.legality, true);
   EXPECT_EQ(global::get_implicit_function()->get_name(), function_name);
   EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
             clean_halide_ir(halide_ir));
 }
 
-TEST(TiraLibCppTest, Reversal)
+std::tuple<Result, std::string> apply_schedule_4d_sample(std::string schedule)
 {
-  std::string schedule = "R(L2,comps=['comp_blur'])";
-  auto result = apply_schedule_blur(schedule);
-
-  Result resultInstance = std::get<0>(result);
-  std::string halide_ir = std::get<1>(result);
-
-  std::string function_name = "function_blur_MINI";
+  std::string function_name = "function_scale_4d_MINI";
 
   tiramisu::init(function_name);
 
   // -------------------------------------------------------
   // Layer I
   // -------------------------------------------------------
-  var xi("xi", 0, 34), yi("yi", 0, 18), ci("ci", 0, 5);
-  var x("x", 1, 34 - 1), y("y", 1, 18 - 1), c("c", 1, 5 - 1);
+  var i("i", 0, 16), j("j", 0, 16), k("k", 0, 16), l("l", 0, 16);
 
   // inputs
-  input input_img("input_img", {ci, yi, xi}, p_float64);
+  input input_img("input_img", {i, j, k, l}, p_float64);
 
   // Computations
-  computation comp_blur("comp_blur", {c, y, x}, (input_img(c, y + 1, x - 1) + input_img(c, y + 1, x) + input_img(c, y + 1, x + 1) + input_img(c, y, x - 1) + input_img(c, y, x) + input_img(c, y, x + 1) + input_img(c, y - 1, x - 1) + input_img(c, y - 1, x) + input_img(c, y - 1, x + 1)) * 0.111111);
+  computation comp_scale("comp_scale", {i, j, k, l}, input_img(i, j, k, l) * 2.0);
 
   // -------------------------------------------------------
   // Layer II
@@ -416,286 +414,747 @@ TEST(TiraLibCppTest, Reversal)
   // Layer III
   // -------------------------------------------------------
   // Buffers
-  buffer input_buf("input_buf", {5, 18, 34}, p_float64, a_input);
-  buffer output_buf("output_buf", {5, 18, 34}, p_float64, a_output);
+  buffer input_buf("input_buf", {16, 16, 16, 16}, p_float64, a_input);
+  buffer output_buf("output_buf", {16, 16, 16, 16}, p_float64, a_output);
 
   // Store inputs
   input_img.store_in(&input_buf);
 
   // Store computations
-  comp_blur.store_in(&output_buf);
+  comp_scale.store_in(&output_buf);
 
   auto buffers = {&input_buf, &output_buf};
 
   // -------------------------------------------------------
   // Code Generation
   // -------------------------------------------------------
-  comp_blur.loop_reversal(2);
-
-  EXPECT_EQ(global::get_implicit_function()->get_name(), function_name);
-  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
-            clean_halide_ir(halide_ir));
-}
-
-TEST(TiraLibCppTest, IllegalAction)
-{
-  std::string schedule = "S(L0,L1,0,0,comps=['comp_blur'])";
-  auto result = apply_schedule_blur(schedule);
-
-  Result resultInstance = std::get<0>(result);
-  std::string halide_ir = std::get<1>(result);
-
-  EXPECT_EQ(resultInstance.legality, false);
-}
-
-std::tuple<Result, std::string> apply_schedule_skewing_sample(std::string schedule)
-{
-  std::string function_name = "function550013";
-
-  tiramisu::init("function550013");
-  var i0("i0", 1, 2049), i1("i1", 1, 2049), i2("i2", 0, 256), i1_p1("i1_p1", 0, 2050), i0_p1("i0_p1", 0, 2050);
-  input icomp00("icomp00", {i0_p1, i1_p1}, p_float64);
-  input input01("input01", {i0_p1}, p_float64);
-  computation comp00("comp00", {i0, i1, i2}, p_float64);
-  comp00.set_expression(icomp00(i0, i1) + icomp00(i0, i1 - 1) * icomp00(i0 + 1, i1) + icomp00(i0, i1 + 1) + icomp00(i0 - 1, i1) + input01(i0) + input01(i0 - 1) - input01(i0 + 1));
-  buffer buf00("buf00", {2050, 2050}, p_float64, a_output);
-  buffer buf01("buf01", {2050}, p_float64, a_input);
-  icomp00.store_in(&buf00);
-  input01.store_in(&buf01);
-  comp00.store_in(&buf00, {i0, i1});
-  tiramisu::codegen({&buf00, &buf01}, "function550013.o");
-
-  // -------------------------------------------------------
-  // Code Generation
-  // -------------------------------------------------------
-
-  auto buffers = {&buf00, &buf01};
-
   auto result = schedule_str_to_result(function_name, schedule, Operation::legality, buffers);
 
-  // make and return a tuple consisting of the result and the halide ir of the function
   std::string halide_ir = global::get_implicit_function()->get_halide_ir(buffers);
 
   return std::tuple<Result, std::string>(result, halide_ir);
 }
 
-TEST(TiraLibCppTest, Skewing)
+TEST(TiraLibCppTest, Tiling4D)
 {
-
-  std::string schedule = "S(L0,L1,0,0,comps=['comp00'])";
-  auto result = apply_schedule_skewing_sample(schedule);
+  std::string schedule = "T(levels=[L0,L1,L2,L3],factors=[4,8,4,8],comps=['comp_scale'])";
+  auto result = apply_schedule_4d_sample(schedule);
 
   Result resultInstance = std::get<0>(result);
   std::string halide_ir = std::get<1>(result);
 
-  tiramisu::init("function550013");
-  var i0("i0", 1, 2049), i1("i1", 1, 2049), i2("i2", 0, 256), i1_p1("i1_p1", 0, 2050), i0_p1("i0_p1", 0, 2050);
-  input icomp00("icomp00", {i0_p1, i1_p1}, p_float64);
-  input input01("input01", {i0_p1}, p_float64);
-  computation comp00("comp00", {i0, i1, i2}, p_float64);
-  comp00.set_expression(icomp00(i0, i1) + icomp00(i0, i1 - 1) * icomp00(i0 + 1, i1) + icomp00(i0, i1 + 1) + icomp00(i0 - 1, i1) + input01(i0) + input01(i0 - 1) - input01(i0 + 1));
-  buffer buf00("buf00", {2050, 2050}, p_float64, a_output);
-  buffer buf01("buf01", {2050}, p_float64, a_input);
-  icomp00.store_in(&buf00);
-  input01.store_in(&buf01);
-  comp00.store_in(&buf00, {i0, i1});
-
-  comp00.skew(0, 1, 1, 1);
-
-  EXPECT_EQ(global::get_implicit_function()->get_name(), "function550013");
-  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir({&buf00, &buf01})), clean_halide_ir(halide_ir));
-}
+  std::string function_name = "function_scale_4d_MINI";
 
-std::tuple<Result, std::string> apply_schedule_multi_comp_sample(std::string schedule)
-{
-  auto function_name = "function_gemver_MINI";
-  tiramisu::init("function_gemver_MINI");
+  tiramisu::init(function_name);
 
   // -------------------------------------------------------
   // Layer I
   // -------------------------------------------------------
-
-  // Iteration variables
-  var i("i", 0, 40), j("j", 0, 40);
+  var i("i", 0, 16), j("j", 0, 16), k("k", 0, 16), l("l", 0, 16);
 
   // inputs
-  input A("A", {i, j}, p_float64);
-  input u1("u1", {i}, p_float64);
-  input u2("u2", {i}, p_float64);
-  input v1("v1", {i}, p_float64);
-  input v2("v2", {i}, p_float64);
-  input y("y", {i}, p_float64);
-  input z("z", {i}, p_float64);
+  input input_img("input_img", {i, j, k, l}, p_float64);
 
   // Computations
-
-  computation A_hat("A_hat", {i, j}, A(i, j) + u1(i) * v1(j) + u2(i) * v2(j));
-  computation x_temp("x_temp", {i, j}, p_float64);
-  x_temp.set_expression(x_temp(i, j) + A_hat(j, i) * y(j) * 1.2);
-  computation x("x", {i}, x_temp(i, 0) + z(i));
-  computation w("w", {i, j}, p_float64);
-  w.set_expression(w(i, j) + A_hat(i, j) * x(j) * 1.5);
+  computation comp_scale("comp_scale", {i, j, k, l}, input_img(i, j, k, l) * 2.0);
 
   // -------------------------------------------------------
   // Layer II
   // -------------------------------------------------------
-  A_hat.then(x_temp, computation::root)
-      .then(x, computation::root)
-      .then(w, computation::root);
 
   // -------------------------------------------------------
   // Layer III
   // -------------------------------------------------------
-  // Input Buffers
-  buffer b_A("b_A", {40, 40}, p_float64, a_input);
-  buffer b_u1("b_u1", {40}, p_float64, a_input);
-  buffer b_u2("b_u2", {40}, p_float64, a_input);
-  buffer b_v1("b_v1", {40}, p_float64, a_input);
-  buffer b_v2("b_v2", {40}, p_float64, a_input);
-  buffer b_z("b_z", {40}, p_float64, a_input);
-  buffer b_y("b_y", {40}, p_float64, a_input);
-  buffer b_A_hat("b_A_hat", {40, 40}, p_float64, a_output);
-  buffer b_x("b_x", {40}, p_float64, a_output);
-  buffer b_w("b_w", {40}, p_float64, a_output);
+  // Buffers
+  buffer input_buf("input_buf", {16, 16, 16, 16}, p_float64, a_input);
+  buffer output_buf("output_buf", {16, 16, 16, 16}, p_float64, a_output);
 
   // Store inputs
-  A.store_in(&b_A);
-  u1.store_in(&b_u1);
-  u2.store_in(&b_u2);
-  v1.store_in(&b_v1);
-  v2.store_in(&b_v2);
-  y.store_in(&b_y);
-  z.store_in(&b_z);
+  input_img.store_in(&input_buf);
 
   // Store computations
-  A_hat.store_in(&b_A_hat);
-  x_temp.store_in(&b_x, {i});
-  x.store_in(&b_x);
-  w.store_in(&b_w, {i});
+  comp_scale.store_in(&output_buf);
+
+  auto buffers = {&input_buf, &output_buf};
 
   // -------------------------------------------------------
   // Code Generation
   // -------------------------------------------------------
+  // Tiramisu tiles at most 3 levels: every level is split (i0 i1 j0 j1 k0 k1 l0 l1) and the outer loops are moved
+  // in front of the inner ones (i0 j0 k0 l0 i1 j1 k1 l1)
+  comp_scale.split(3, 8);
+  comp_scale.split(2, 4);
+  comp_scale.split(1, 8);
+  comp_scale.split(0, 4);
+  comp_scale.interchange(1, 2);
+  comp_scale.interchange(3, 4);
+  comp_scale.interchange(2, 3);
+  comp_scale.interchange(5, 6);
+  comp_scale.interchange(4, 5);
+  comp_scale.interchange(3, 4);
 
-  auto buffers = {&b_A, &b_u1, &b_u2, &b_v1, &b_v2, &b_y, &b_z, &b_A_hat, &b_x, &b_w};
-
-  auto result = schedule_str_to_result(function_name, schedule, Operation::legality, buffers);
-
-  // make and return a tuple consisting of the result and the halide ir of the function
-  std::string halide_ir = global::get_implicit_function()->get_halide_ir(buffers);
-
-  return std::tuple<Result, std::string>(result, halide_ir);
+  EXPECT_EQ(resultInstance.legality, true);
+  EXPECT_EQ(global::get_implicit_function()->get_name(), function_name);
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
+            clean_halide_ir(halide_ir));
 }
 
-TEST(TiraLibCppTest, FusionIllegal)
+TEST(TiraLibCppTest, Tiling3D)
 {
-
-  std::string schedule = "F(L0,comps=['A_hat', 'x_temp'])";
-  auto result = apply_schedule_multi_comp_sample(schedule);
+  std::string schedule = "T3(L0,L1,L2,32,32,32,comps=['comp_blur'])";
+  auto result = apply_schedule_blur(schedule);
 
   Result resultInstance = std::get<0>(result);
   std::string halide_ir = std::get<1>(result);
 
-  auto function_name = "function_gemver_MINI";
-  tiramisu::init("function_gemver_MINI");
+  std::string function_name = "function_blur_MINI";
+
+  tiramisu::init(function_name);
 
   // -------------------------------------------------------
   // Layer I
   // -------------------------------------------------------
-
-  // Iteration variables
-  var i("i", 0, 40), j("j", 0, 40);
+  var xi("xi", 0, 34), yi("yi", 0, 18), ci("ci", 0, 5);
+  var x("x", 1, 34 - 1), y("y", 1, 18 - 1), c("c", 1, 5 - 1);
 
   // inputs
-  input A("A", {i, j}, p_float64);
-  input u1("u1", {i}, p_float64);
-  input u2("u2", {i}, p_float64);
-  input v1("v1", {i}, p_float64);
-  input v2("v2", {i}, p_float64);
-  input y("y", {i}, p_float64);
-  input z("z", {i}, p_float64);
+  input input_img("input_img", {ci, yi, xi}, p_float64);
 
   // Computations
-
-  computation A_hat("A_hat", {i, j}, A(i, j) + u1(i) * v1(j) + u2(i) * v2(j));
-  computation x_temp("x_temp", {i, j}, p_float64);
-  x_temp.set_expression(x_temp(i, j) + A_hat(j, i) * y(j) * 1.2);
-  computation x("x", {i}, x_temp(i, 0) + z(i));
-  computation w("w", {i, j}, p_float64);
-  w.set_expression(w(i, j) + A_hat(i, j) * x(j) * 1.5);
+  computation comp_blur("comp_blur", {c, y, x}, (input_img(c, y + 1, x - 1) + input_img(c, y + 1, x) + input_img(c, y + 1, x + 1) + input_img(c, y, x - 1) + input_img(c, y, x) + input_img(c, y, x + 1) + input_img(c, y - 1, x - 1) + input_img(c, y - 1, x) + input_img(c, y - 1, x + 1)) * 0.111111);
 
   // -------------------------------------------------------
   // Layer II
   // -------------------------------------------------------
-  A_hat.then(x_temp, computation::root)
-      .then(x, computation::root)
-      .then(w, computation::root);
 
   // -------------------------------------------------------
   // Layer III
   // -------------------------------------------------------
-  // Input Buffers
-  buffer b_A("b_A", {40, 40}, p_float64, a_input);
-  buffer b_u1("b_u1", {40}, p_float64, a_input);
-  buffer b_u2("b_u2", {40}, p_float64, a_input);
-  buffer b_v1("b_v1", {40}, p_float64, a_input);
-  buffer b_v2("b_v2", {40}, p_float64, a_input);
-  buffer b_z("b_z", {40}, p_float64, a_input);
-  buffer b_y("b_y", {40}, p_float64, a_input);
-  buffer b_A_hat("b_A_hat", {40, 40}, p_float64, a_output);
-  buffer b_x("b_x", {40}, p_float64, a_output);
-  buffer b_w("b_w", {40}, p_float64, a_output);
+  // Buffers
+  buffer input_buf("input_buf", {5, 18, 34}, p_float64, a_input);
+  buffer output_buf("output_buf", {5, 18, 34}, p_float64, a_output);
 
   // Store inputs
-  A.store_in(&b_A);
-  u1.store_in(&b_u1);
-  u2.store_in(&b_u2);
-  v1.store_in(&b_v1);
-  v2.store_in(&b_v2);
-  y.store_in(&b_y);
-  z.store_in(&b_z);
+  input_img.store_in(&input_buf);
 
   // Store computations
-  A_hat.store_in(&b_A_hat);
-  x_temp.store_in(&b_x, {i});
-  x.store_in(&b_x);
-  w.store_in(&b_w, {i});
+  comp_blur.store_in(&output_buf);
 
-  EXPECT_EQ(resultInstance.legality, false);
+  auto buffers = {&input_buf, &output_buf};
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  comp_blur.tile(0, 1, 2, 32, 32, 32);
+
+  EXPECT_EQ(global::get_implicit_function()->get_name(), function_name);
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
+            clean_halide_ir(halide_ir));
 }
 
-TEST(TiraLibCppTest, FusionLegal)
+TEST(TiraLibCppTest, Unrolling)
 {
-
-  std::string schedule = "I(L0,L1,comps=['x_temp'])|F(L0,comps=['A_hat', 'x_temp'])";
-  auto result = apply_schedule_multi_comp_sample(schedule);
+  std::string schedule = "U(L2,32,comps=['comp_blur'])";
+  auto result = apply_schedule_blur(schedule);
 
   Result resultInstance = std::get<0>(result);
   std::string halide_ir = std::get<1>(result);
 
-  auto function_name = "function_gemver_MINI";
-  tiramisu::init("function_gemver_MINI");
+  std::string function_name = "function_blur_MINI";
+
+  tiramisu::init(function_name);
 
   // -------------------------------------------------------
   // Layer I
   // -------------------------------------------------------
-
-  // Iteration variables
-  var i("i", 0, 40), j("j", 0, 40);
+  var xi("xi", 0, 34), yi("yi", 0, 18), ci("ci", 0, 5);
+  var x("x", 1, 34 - 1), y("y", 1, 18 - 1), c("c", 1, 5 - 1);
 
   // inputs
-  input A("A", {i, j}, p_float64);
-  input u1("u1", {i}, p_float64);
-  input u2("u2", {i}, p_float64);
-  input v1("v1", {i}, p_float64);
-  input v2("v2", {i}, p_float64);
-  input y("y", {i}, p_float64);
-  input z("z", {i}, p_float64);
+  input input_img("input_img", {ci, yi, xi}, p_float64);
 
   // Computations
+  computation comp_blur("comp_blur", {c, y, x}, (input_img(c, y + 1, x - 1) + input_img(c, y + 1, x) + input_img(c, y + 1, x + 1) + input_img(c, y, x - 1) + input_img(c, y, x) + input_img(c, y, x + 1) + input_img(c, y - 1, x - 1) + input_img(c, y - 1, x) + input_img(c, y - 1, x + 1)) * 0.111111);
 
-  computation A_hat("A_hat", {i, j}, A(i, j) + u1(i) * v1(j) + u2(i) * v2(j));
-  computation x_temp("x_temp", {i, j}, p_float64);
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Buffers
+  buffer input_buf("input_buf", {5, 18, 34}, p_float64, a_input);
+  buffer output_buf("output_buf", {5, 18, 34}, p_float64, a_output);
+
+  // Store inputs
+  input_img.store_in(&input_buf);
+
+  // Store computations
+  comp_blur.store_in(&output_buf);
+
+  auto buffers = {&input_buf, &output_buf};
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  comp_blur.unroll(2, 32);
+
+  EXPECT_EQ(global::get_implicit_function()->get_name(), function_name);
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
+            clean_halide_ir(halide_ir));
+}
+
+TEST(TiraLibCppTest, Vectorization)
+{
+  std::string schedule = "V(L2,4,comps=['comp_blur'])";
+  auto result = apply_schedule_blur(schedule);
+
+  Result resultInstance = std::get<0>(result);
+  std::string halide_ir = std::get<1>(result);
+
+  std::string function_name = "function_blur_MINI";
+
+  tiramisu::init(function_name);
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+  var xi("xi", 0, 34), yi("yi", 0, 18), ci("ci", 0, 5);
+  var x("x", 1, 34 - 1), y("y", 1, 18 - 1), c("c", 1, 5 - 1);
+
+  // inputs
+  input input_img("input_img", {ci, yi, xi}, p_float64);
+
+  // Computations
+  computation comp_blur("comp_blur", {c, y, x}, (input_img(c, y + 1, x - 1) + input_img(c, y + 1, x) + input_img(c, y + 1, x + 1) + input_img(c, y, x - 1) + input_img(c, y, x) + input_img(c, y, x + 1) + input_img(c, y - 1, x - 1) + input_img(c, y - 1, x) + input_img(c, y - 1, x + 1)) * 0.111111);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Buffers
+  buffer input_buf("input_buf", {5, 18, 34}, p_float64, a_input);
+  buffer output_buf("output_buf", {5, 18, 34}, p_float64, a_output);
+
+  // Store inputs
+  input_img.store_in(&input_buf);
+
+  // Store computations
+  comp_blur.store_in(&output_buf);
+
+  auto buffers = {&input_buf, &output_buf};
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  comp_blur.vectorize(x, 4);
+
+  EXPECT_EQ(resultInstance.legality, true);
+  EXPECT_EQ(resultInstance.additional_info, "vectorization_width:4");
+  EXPECT_EQ(global::get_implicit_function()->get_name(), function_name);
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
+            clean_halide_ir(halide_ir));
+}
+
+TEST(TiraLibCppTest, VectorizationWiderThanLoop)
+{
+  std::string schedule = "V(L2,64,comps=['comp_blur'])";
+  auto result = apply_schedule_blur(schedule);
+
+  Result resultInstance = std::get<0>(result);
+  std::string halide_ir = std::get<1>(result);
+
+  std::string function_name = "function_blur_MINI";
+
+  tiramisu::init(function_name);
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+  var xi("xi", 0, 34), yi("yi", 0, 18), ci("ci", 0, 5);
+  var x("x", 1, 34 - 1), y("y", 1, 18 - 1), c("c", 1, 5 - 1);
+
+  // inputs
+  input input_img("input_img", {ci, yi, xi}, p_float64);
+
+  // Computations
+  computation comp_blur("comp_blur", {c, y, x}, (input_img(c, y + 1, x - 1) + input_img(c, y + 1, x) + input_img(c, y + 1, x + 1) + input_img(c, y, x - 1) + input_img(c, y, x) + input_img(c, y, x + 1) + input_img(c, y - 1, x - 1) + input_img(c, y - 1, x) + input_img(c, y - 1, x + 1)) * 0.111111);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Buffers
+  buffer input_buf("input_buf", {5, 18, 34}, p_float64, a_input);
+  buffer output_buf("output_buf", {5, 18, 34}, p_float64, a_output);
+
+  // Store inputs
+  input_img.store_in(&input_buf);
+
+  // Store computations
+  comp_blur.store_in(&output_buf);
+
+  auto buffers = {&input_buf, &output_buf};
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  // x has 32 iterations, so the vector width is the largest power of two that fits in the loop
+  comp_blur.vectorize(x, 32);
+
+  EXPECT_EQ(resultInstance.legality, true);
+  EXPECT_EQ(resultInstance.additional_info, "vectorization_width:32");
+  EXPECT_EQ(global::get_implicit_function()->get_name(), function_name);
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
+            clean_halide_ir(halide_ir));
+}
+
+TEST(TiraLibCppTest, VectorizationWidthNotPowerOfTwo)
+{
+  // 24 lanes do not fit in the 3 iterations of c and are clamped to a power of two
+  std::string schedule = "I(L0,L2,comps=['comp_blur'])|V(L2,24,comps=['comp_blur'])";
+  auto result = apply_schedule_blur(schedule);
+
+  EXPECT_EQ(std::get<0>(result).legality, true);
+  EXPECT_EQ(std::get<0>(result).additional_info, "vectorization_width:2");
+}
+
+TEST(TiraLibCppTest, VectorizationZeroWidth)
+{
+  std::string schedule = "V(L2,0,comps=['comp_blur'])";
+
+  EXPECT_THROW(apply_schedule_blur(schedule), std::invalid_argument);
+}
+
+TEST(TiraLibCppTest, VectorizationNonDivisibleExtent)
+{
+  std::string schedule = "I(L0,L2,comps=['comp_blur'])|V(L2,4,comps=['comp_blur'])";
+  auto result = apply_schedule_blur(schedule);
+
+  Result resultInstance = std::get<0>(result);
+  std::string halide_ir = std::get<1>(result);
+
+  std::string function_name = "function_blur_MINI";
+
+  tiramisu::init(function_name);
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+  var xi("xi", 0, 34), yi("yi", 0, 18), ci("ci", 0, 5);
+  var x("x", 1, 34 - 1), y("y", 1, 18 - 1), c("c", 1, 5 - 1);
+
+  // inputs
+  input input_img("input_img", {ci, yi, xi}, p_float64);
+
+  // Computations
+  computation comp_blur("comp_blur", {c, y, x}, (input_img(c, y + 1, x - 1) + input_img(c, y + 1, x) + input_img(c, y + 1, x + 1) + input_img(c, y, x - 1) + input_img(c, y, x) + input_img(c, y, x + 1) + input_img(c, y - 1, x - 1) + input_img(c, y - 1, x) + input_img(c, y - 1, x + 1)) * 0.111111);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Buffers
+  buffer input_buf("input_buf", {5, 18, 34}, p_float64, a_input);
+  buffer output_buf("output_buf", {5, 18, 34}, p_float64, a_output);
+
+  // Store inputs
+  input_img.store_in(&input_buf);
+
+  // Store computations
+  comp_blur.store_in(&output_buf);
+
+  auto buffers = {&input_buf, &output_buf};
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  // c has 3 iterations after the interchange: 4 lanes do not fit, 2 do and leave a scalar epilogue of 1 iteration
+  comp_blur.interchange(0, 2);
+  comp_blur.vectorize(c, 2);
+
+  EXPECT_EQ(resultInstance.legality, true);
+  EXPECT_EQ(resultInstance.additional_info, "vectorization_width:2");
+  EXPECT_EQ(global::get_implicit_function()->get_name(), function_name);
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
+            clean_halide_ir(halide_ir));
+}
+
+TEST(TiraLibCppTest, Interchange)
+{
+  std::string schedule = "I(L0,L1,comps=['comp_blur'])";
+  auto result = apply_schedule_blur(schedule);
+
+  Result resultInstance = std::get<0>(result);
+  std::string halide_ir = std::get<1>(result);
+
+  std::string function_name = "function_blur_MINI";
+
+  tiramisu::init(function_name);
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+  var xi("xi", 0, 34), yi("yi", 0, 18), ci("ci", 0, 5);
+  var x("x", 1, 34 - 1), y("y", 1, 18 - 1), c("c", 1, 5 - 1);
+
+  // inputs
+  input input_img("input_img", {ci, yi, xi}, p_float64);
+
+  // Computations
+  computation comp_blur("comp_blur", {c, y, x}, (input_img(c, y + 1, x - 1) + input_img(c, y + 1, x) + input_img(c, y + 1, x + 1) + input_img(c, y, x - 1) + input_img(c, y, x) + input_img(c, y, x + 1) + input_img(c, y - 1, x - 1) + input_img(c, y - 1, x) + input_img(c, y - 1, x + 1)) * 0.111111);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Buffers
+  buffer input_buf("input_buf", {5, 18, 34}, p_float64, a_input);
+  buffer output_buf("output_buf", {5, 18, 34}, p_float64, a_output);
+
+  // Store inputs
+  input_img.store_in(&input_buf);
+
+  // Store computations
+  comp_blur.store_in(&output_buf);
+
+  auto buffers = {&input_buf, &output_buf};
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  comp_blur.interchange(0, 1);
+
+  EXPECT_EQ(global::get_implicit_function()->get_name(), function_name);
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
+            clean_halide_ir(halide_ir));
+}
+
+TEST(TiraLibCppTest, Reversal)
+{
+  std::string schedule = "R(L2,comps=['comp_blur'])";
+  auto result = apply_schedule_blur(schedule);
+
+  Result resultInstance = std::get<0>(result);
+  std::string halide_ir = std::get<1>(result);
+
+  std::string function_name = "function_blur_MINI";
+
+  tiramisu::init(function_name);
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+  var xi("xi", 0, 34), yi("yi", 0, 18), ci("ci", 0, 5);
+  var x("x", 1, 34 - 1), y("y", 1, 18 - 1), c("c", 1, 5 - 1);
+
+  // inputs
+  input input_img("input_img", {ci, yi, xi}, p_float64);
+
+  // Computations
+  computation comp_blur("comp_blur", {c, y, x}, (input_img(c, y + 1, x - 1) + input_img(c, y + 1, x) + input_img(c, y + 1, x + 1) + input_img(c, y, x - 1) + input_img(c, y, x) + input_img(c, y, x + 1) + input_img(c, y - 1, x - 1) + input_img(c, y - 1, x) + input_img(c, y - 1, x + 1)) * 0.111111);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Buffers
+  buffer input_buf("input_buf", {5, 18, 34}, p_float64, a_input);
+  buffer output_buf("output_buf", {5, 18, 34}, p_float64, a_output);
+
+  // Store inputs
+  input_img.store_in(&input_buf);
+
+  // Store computations
+  comp_blur.store_in(&output_buf);
+
+  auto buffers = {&input_buf, &output_buf};
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  comp_blur.loop_reversal(2);
+
+  EXPECT_EQ(global::get_implicit_function()->get_name(), function_name);
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
+            clean_halide_ir(halide_ir));
+}
+
+TEST(TiraLibCppTest, IllegalAction)
+{
+  std::string schedule = "S(L0,L1,0,0,comps=['comp_blur'])";
+  auto result = apply_schedule_blur(schedule);
+
+  Result resultInstance = std::get<0>(result);
+  std::string halide_ir = std::get<1>(result);
+
+  EXPECT_EQ(resultInstance.legality, false);
+}
+
+std::tuple<Result, std::string> apply_schedule_skewing_sample(std::string schedule, Operation operation = Operation::legality)
+{
+  std::string function_name = "function550013";
+
+  tiramisu::init("function550013");
+  var i0("i0", 1, 2049), i1("i1", 1, 2049), i2("i2", 0, 256), i1_p1("i1_p1", 0, 2050), i0_p1("i0_p1", 0, 2050);
+  input icomp00("icomp00", {i0_p1, i1_p1}, p_float64);
+  input input01("input01", {i0_p1}, p_float64);
+  computation comp00("comp00", {i0, i1, i2}, p_float64);
+  comp00.set_expression(icomp00(i0, i1) + icomp00(i0, i1 - 1) * icomp00(i0 + 1, i1) + icomp00(i0, i1 + 1) + icomp00(i0 - 1, i1) + input01(i0) + input01(i0 - 1) - input01(i0 + 1));
+  buffer buf00("buf00", {2050, 2050}, p_float64, a_output);
+  buffer buf01("buf01", {2050}, p_float64, a_input);
+  icomp00.store_in(&buf00);
+  input01.store_in(&buf01);
+  comp00.store_in(&buf00, {i0, i1});
+  tiramisu::codegen({&buf00, &buf01}, "function550013.o");
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+
+  auto buffers = {&buf00, &buf01};
+
+  auto result = schedule_str_to_result(function_name, schedule, operation, buffers);
+
+  // make and return a tuple consisting of the result and the halide ir of the function
+  std::string halide_ir = global::get_implicit_function()->get_halide_ir(buffers);
+
+  return std::tuple<Result, std::string>(result, halide_ir);
+}
+
+TEST(TiraLibCppTest, Skewing)
+{
+
+  std::string schedule = "S(L0,L1,0,0,comps=['comp00'])";
+  auto result = apply_schedule_skewing_sample(schedule);
+
+  Result resultInstance = std::get<0>(result);
+  std::string halide_ir = std::get<1>(result);
+
+  tiramisu::init("function550013");
+  var i0("i0", 1, 2049), i1("i1", 1, 2049), i2("i2", 0, 256), i1_p1("i1_p1", 0, 2050), i0_p1("i0_p1", 0, 2050);
+  input icomp00("icomp00", {i0_p1, i1_p1}, p_float64);
+  input input01("input01", {i0_p1}, p_float64);
+  computation comp00("comp00", {i0, i1, i2}, p_float64);
+  comp00.set_expression(icomp00(i0, i1) + icomp00(i0, i1 - 1) * icomp00(i0 + 1, i1) + icomp00(i0, i1 + 1) + icomp00(i0 - 1, i1) + input01(i0) + input01(i0 - 1) - input01(i0 + 1));
+  buffer buf00("buf00", {2050, 2050}, p_float64, a_output);
+  buffer buf01("buf01", {2050}, p_float64, a_input);
+  icomp00.store_in(&buf00);
+  input01.store_in(&buf01);
+  comp00.store_in(&buf00, {i0, i1});
+
+  comp00.skew(0, 1, 1, 1);
+
+  EXPECT_EQ(global::get_implicit_function()->get_name(), "function550013");
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir({&buf00, &buf01})), clean_halide_ir(halide_ir));
+}
+
+std::tuple<Result, std::string> apply_schedule_multi_comp_sample(std::string schedule)
+{
+  auto function_name = "function_gemver_MINI";
+  tiramisu::init("function_gemver_MINI");
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+
+  // Iteration variables
+  var i("i", 0, 40), j("j", 0, 40);
+
+  // inputs
+  input A("A", {i, j}, p_float64);
+  input u1("u1", {i}, p_float64);
+  input u2("u2", {i}, p_float64);
+  input v1("v1", {i}, p_float64);
+  input v2("v2", {i}, p_float64);
+  input y("y", {i}, p_float64);
+  input z("z", {i}, p_float64);
+
+  // Computations
+
+  computation A_hat("A_hat", {i, j}, A(i, j) + u1(i) * v1(j) + u2(i) * v2(j));
+  computation x_temp("x_temp", {i, j}, p_float64);
+  x_temp.set_expression(x_temp(i, j) + A_hat(j, i) * y(j) * 1.2);
+  computation x("x", {i}, x_temp(i, 0) + z(i));
+  computation w("w", {i, j}, p_float64);
+  w.set_expression(w(i, j) + A_hat(i, j) * x(j) * 1.5);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+  A_hat.then(x_temp, computation::root)
+      .then(x, computation::root)
+      .then(w, computation::root);
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Input Buffers
+  buffer b_A("b_A", {40, 40}, p_float64, a_input);
+  buffer b_u1("b_u1", {40}, p_float64, a_input);
+  buffer b_u2("b_u2", {40}, p_float64, a_input);
+  buffer b_v1("b_v1", {40}, p_float64, a_input);
+  buffer b_v2("b_v2", {40}, p_float64, a_input);
+  buffer b_z("b_z", {40}, p_float64, a_input);
+  buffer b_y("b_y", {40}, p_float64, a_input);
+  buffer b_A_hat("b_A_hat", {40, 40}, p_float64, a_output);
+  buffer b_x("b_x", {40}, p_float64, a_output);
+  buffer b_w("b_w", {40}, p_float64, a_output);
+
+  // Store inputs
+  A.store_in(&b_A);
+  u1.store_in(&b_u1);
+  u2.store_in(&b_u2);
+  v1.store_in(&b_v1);
+  v2.store_in(&b_v2);
+  y.store_in(&b_y);
+  z.store_in(&b_z);
+
+  // Store computations
+  A_hat.store_in(&b_A_hat);
+  x_temp.store_in(&b_x, {i});
+  x.store_in(&b_x);
+  w.store_in(&b_w, {i});
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+
+  auto buffers = {&b_A, &b_u1, &b_u2, &b_v1, &b_v2, &b_y, &b_z, &b_A_hat, &b_x, &b_w};
+
+  auto result = schedule_str_to_result(function_name, schedule, Operation::legality, buffers);
+
+  // make and return a tuple consisting of the result and the halide ir of the function
+  std::string halide_ir = global::get_implicit_function()->get_halide_ir(buffers);
+
+  return std::tuple<Result, std::string>(result, halide_ir);
+}
+
+TEST(TiraLibCppTest, FusionIllegal)
+{
+
+  std::string schedule = "F(L0,comps=['A_hat', 'x_temp'])";
+  auto result = apply_schedule_multi_comp_sample(schedule);
+
+  Result resultInstance = std::get<0>(result);
+  std::string halide_ir = std::get<1>(result);
+
+  auto function_name = "function_gemver_MINI";
+  tiramisu::init("function_gemver_MINI");
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+
+  // Iteration variables
+  var i("i", 0, 40), j("j", 0, 40);
+
+  // inputs
+  input A("A", {i, j}, p_float64);
+  input u1("u1", {i}, p_float64);
+  input u2("u2", {i}, p_float64);
+  input v1("v1", {i}, p_float64);
+  input v2("v2", {i}, p_float64);
+  input y("y", {i}, p_float64);
+  input z("z", {i}, p_float64);
+
+  // Computations
+
+  computation A_hat("A_hat", {i, j}, A(i, j) + u1(i) * v1(j) + u2(i) * v2(j));
+  computation x_temp("x_temp", {i, j}, p_float64);
+  x_temp.set_expression(x_temp(i, j) + A_hat(j, i) * y(j) * 1.2);
+  computation x("x", {i}, x_temp(i, 0) + z(i));
+  computation w("w", {i, j}, p_float64);
+  w.set_expression(w(i, j) + A_hat(i, j) * x(j) * 1.5);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+  A_hat.then(x_temp, computation::root)
+      .then(x, computation::root)
+      .then(w, computation::root);
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Input Buffers
+  buffer b_A("b_A", {40, 40}, p_float64, a_input);
+  buffer b_u1("b_u1", {40}, p_float64, a_input);
+  buffer b_u2("b_u2", {40}, p_float64, a_input);
+  buffer b_v1("b_v1", {40}, p_float64, a_input);
+  buffer b_v2("b_v2", {40}, p_float64, a_input);
+  buffer b_z("b_z", {40}, p_float64, a_input);
+  buffer b_y("b_y", {40}, p_float64, a_input);
+  buffer b_A_hat("b_A_hat", {40, 40}, p_float64, a_output);
+  buffer b_x("b_x", {40}, p_float64, a_output);
+  buffer b_w("b_w", {40}, p_float64, a_output);
+
+  // Store inputs
+  A.store_in(&b_A);
+  u1.store_in(&b_u1);
+  u2.store_in(&b_u2);
+  v1.store_in(&b_v1);
+  v2.store_in(&b_v2);
+  y.store_in(&b_y);
+  z.store_in(&b_z);
+
+  // Store computations
+  A_hat.store_in(&b_A_hat);
+  x_temp.store_in(&b_x, {i});
+  x.store_in(&b_x);
+  w.store_in(&b_w, {i});
+
+  EXPECT_EQ(resultInstance.legality, false);
+}
+
+TEST(TiraLibCppTest, FusionLegal)
+{
+
+  std::string schedule = "I(L0,L1,comps=['x_temp'])|F(L0,comps=['A_hat', 'x_temp'])";
+  auto result = apply_schedule_multi_comp_sample(schedule);
+
+  Result resultInstance = std::get<0>(result);
+  std::string halide_ir = std::get<1>(result);
+
+  auto function_name = "function_gemver_MINI";
+  tiramisu::init("function_gemver_MINI");
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+
+  // Iteration variables
+  var i("i", 0, 40), j("j", 0, 40);
+
+  // inputs
+  input A("A", {i, j}, p_float64);
+  input u1("u1", {i}, p_float64);
+  input u2("u2", {i}, p_float64);
+  input v1("v1", {i}, p_float64);
+  input v2("v2", {i}, p_float64);
+  input y("y", {i}, p_float64);
+  input z("z", {i}, p_float64);
+
+  // Computations
+
+  computation A_hat("A_hat", {i, j}, A(i, j) + u1(i) * v1(j) + u2(i) * v2(j));
+  computation x_temp("x_temp", {i, j}, p_float64);
   x_temp.set_expression(x_temp(i, j) + A_hat(j, i) * y(j) * 1.2);
   computation x("x", {i}, x_temp(i, 0) + z(i));
   computation w("w", {i, j}, p_float64);
@@ -704,51 +1163,671 @@ TEST(TiraLibCppTest, FusionLegal)
   // -------------------------------------------------------
   // Layer II
   // -------------------------------------------------------
-  A_hat.then(x_temp, computation::root)
-      .then(x, computation::root)
-      .then(w, computation::root);
+  A_hat.then(x_temp, computation::root)
+      .then(x, computation::root)
+      .then(w, computation::root);
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Input Buffers
+  buffer b_A("b_A", {40, 40}, p_float64, a_input);
+  buffer b_u1("b_u1", {40}, p_float64, a_input);
+  buffer b_u2("b_u2", {40}, p_float64, a_input);
+  buffer b_v1("b_v1", {40}, p_float64, a_input);
+  buffer b_v2("b_v2", {40}, p_float64, a_input);
+  buffer b_z("b_z", {40}, p_float64, a_input);
+  buffer b_y("b_y", {40}, p_float64, a_input);
+  buffer b_A_hat("b_A_hat", {40, 40}, p_float64, a_output);
+  buffer b_x("b_x", {40}, p_float64, a_output);
+  buffer b_w("b_w", {40}, p_float64, a_output);
+
+  // Store inputs
+  A.store_in(&b_A);
+  u1.store_in(&b_u1);
+  u2.store_in(&b_u2);
+  v1.store_in(&b_v1);
+  v2.store_in(&b_v2);
+  y.store_in(&b_y);
+  z.store_in(&b_z);
+
+  // Store computations
+  A_hat.store_in(&b_A_hat);
+  x_temp.store_in(&b_x, {i});
+  x.store_in(&b_x);
+  w.store_in(&b_w, {i});
+
+  x_temp.interchange(0, 1);
+  A_hat.then(x_temp, 0).then(x, -1).then(w, -1);
+
+  EXPECT_EQ(resultInstance.legality, true);
+  EXPECT_EQ(global::get_implicit_function()->get_name(), "function_gemver_MINI");
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir({&b_A, &b_u1, &b_u2, &b_v1, &b_v2, &b_y, &b_z, &b_A_hat, &b_x, &b_w})), clean_halide_ir(halide_ir));
+}
+
+// three pointwise stages, each in its own loop nest or all in the same one. stage1 is also an output.
+std::tuple<Result, std::string> apply_schedule_three_stage_sample(std::string schedule, bool shared_nest = false)
+{
+  std::string function_name = "function_three_stages_MINI";
+
+  tiramisu::init(function_name);
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+  var i("i", 0, 32), j("j", 0, 32);
+
+  // inputs
+  input input_img("input_img", {i, j}, p_float64);
+
+  // Computations
+  computation stage0("stage0", {i, j}, input_img(i, j) + 1.0);
+  computation stage1("stage1", {i, j}, stage0(i, j) * 2.0);
+  computation stage2("stage2", {i, j}, stage1(i, j) - 3.0);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+  if (shared_nest)
+    stage0.then(stage1, 1).then(stage2, 1);
+  else
+    stage0.then(stage1, computation::root).then(stage2, computation::root);
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Buffers
+  buffer input_buf("input_buf", {32, 32}, p_float64, a_input);
+  buffer stage0_buf("stage0_buf", {32, 32}, p_float64, a_temporary);
+  buffer stage1_buf("stage1_buf", {32, 32}, p_float64, a_output);
+  buffer output_buf("output_buf", {32, 32}, p_float64, a_output);
+
+  // Store inputs
+  input_img.store_in(&input_buf);
+
+  // Store computations
+  stage0.store_in(&stage0_buf);
+  stage1.store_in(&stage1_buf);
+  stage2.store_in(&output_buf);
+
+  auto buffers = {&input_buf, &stage1_buf, &output_buf};
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  auto result = schedule_str_to_result(function_name, schedule, Operation::legality, buffers);
+
+  std::string halide_ir = global::get_implicit_function()->get_halide_ir(buffers);
+
+  return std::tuple<Result, std::string>(result, halide_ir);
+}
+
+TEST(TiraLibCppTest, FusionThreeComputations)
+{
+  std::string schedule = "F(L1,comps=['stage0', 'stage1', 'stage2'])";
+  auto result = apply_schedule_three_stage_sample(schedule);
+
+  Result resultInstance = std::get<0>(result);
+  std::string halide_ir = std::get<1>(result);
+
+  std::string function_name = "function_three_stages_MINI";
+
+  tiramisu::init(function_name);
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+  var i("i", 0, 32), j("j", 0, 32);
+
+  // inputs
+  input input_img("input_img", {i, j}, p_float64);
+
+  // Computations
+  computation stage0("stage0", {i, j}, input_img(i, j) + 1.0);
+  computation stage1("stage1", {i, j}, stage0(i, j) * 2.0);
+  computation stage2("stage2", {i, j}, stage1(i, j) - 3.0);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+  stage0.then(stage1, computation::root).then(stage2, computation::root);
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Buffers
+  buffer input_buf("input_buf", {32, 32}, p_float64, a_input);
+  buffer stage0_buf("stage0_buf", {32, 32}, p_float64, a_temporary);
+  buffer stage1_buf("stage1_buf", {32, 32}, p_float64, a_output);
+  buffer output_buf("output_buf", {32, 32}, p_float64, a_output);
+
+  // Store inputs
+  input_img.store_in(&input_buf);
+
+  // Store computations
+  stage0.store_in(&stage0_buf);
+  stage1.store_in(&stage1_buf);
+  stage2.store_in(&output_buf);
+
+  auto buffers = {&input_buf, &stage1_buf, &output_buf};
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  // every stage reads the element the previous one just wrote, no shift is needed
+  stage0.then(stage1, 1).then(stage2, 1);
+
+  EXPECT_EQ(resultInstance.legality, true);
+  EXPECT_EQ(resultInstance.additional_info, "");
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
+            clean_halide_ir(halide_ir));
+}
+
+TEST(TiraLibCppTest, FusionThreeComputationsFailure)
+{
+  // x_temp reads the transpose of A_hat, no shift of its loops makes it legal to fuse at L0 with A_hat
+  std::string schedule = "F(L0,comps=['A_hat', 'x_temp', 'x'])";
+  auto result = apply_schedule_multi_comp_sample(schedule);
+
+  Result resultInstance = std::get<0>(result);
+
+  EXPECT_EQ(resultInstance.additional_info, "fusion_failed:x_temp");
+  EXPECT_EQ(resultInstance.legality, false);
+}
+
+TEST(TiraLibCppTest, FusionSingleComputation)
+{
+  std::string schedule = "F(L0,comps=['A_hat'])";
+
+  EXPECT_THROW(apply_schedule_multi_comp_sample(schedule), std::invalid_argument);
+}
+
+TEST(TiraLibCppTest, Matrix)
+{
+  std::string schedule = "M([0, 1, 0, 1, 0, 0, 0, 0, 1],comps=['comp_blur'])";
+  auto result = apply_schedule_blur(schedule);
+
+  Result resultInstance = std::get<0>(result);
+  std::string halide_ir = std::get<1>(result);
+
+  std::string function_name = "function_blur_MINI";
+
+  tiramisu::init(function_name);
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+  var xi("xi", 0, 34), yi("yi", 0, 18), ci("ci", 0, 5);
+  var x("x", 1, 34 - 1), y("y", 1, 18 - 1), c("c", 1, 5 - 1);
+
+  // inputs
+  input input_img("input_img", {ci, yi, xi}, p_float64);
+
+  // Computations
+  computation comp_blur("comp_blur", {c, y, x}, (input_img(c, y + 1, x - 1) + input_img(c, y + 1, x) + input_img(c, y + 1, x + 1) + input_img(c, y, x - 1) + input_img(c, y, x) + input_img(c, y, x + 1) + input_img(c, y - 1, x - 1) + input_img(c, y - 1, x) + input_img(c, y - 1, x + 1)) * 0.111111);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Buffers
+  buffer input_buf("input_buf", {5, 18, 34}, p_float64, a_input);
+  buffer output_buf("output_buf", {5, 18, 34}, p_float64, a_output);
+
+  // Store inputs
+  input_img.store_in(&input_buf);
+
+  // Store computations
+  comp_blur.store_in(&output_buf);
+
+  auto buffers = {&input_buf, &output_buf};
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  comp_blur.matrix_transform({{0, 1, 0}, {1, 0, 0}, {0, 0, 1}});
+
+  EXPECT_EQ(global::get_implicit_function()->get_name(), function_name);
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
+            clean_halide_ir(halide_ir));
+}
+
+std::tuple<Result, std::string> apply_schedule_two_stage_blur(std::string schedule)
+{
+  std::string function_name = "function_blur_xy_MINI";
+
+  tiramisu::init(function_name);
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+  var ci("ci", 0, 3), yi("yi", 0, 18), xi("xi", 0, 18);
+  var c("c", 0, 3), y0("y0", 0, 18), x0("x0", 0, 16);
+  var y("y", 0, 16), x("x", 0, 16);
+
+  // inputs
+  input input_img("input_img", {ci, yi, xi}, p_float64);
+
+  // Computations
+  computation blur_x("blur_x", {c, y0, x0}, (input_img(c, y0, x0) + input_img(c, y0, x0 + 1) + input_img(c, y0, x0 + 2)) * 0.333333);
+  computation blur_y("blur_y", {c, y, x}, (blur_x(c, y, x) + blur_x(c, y + 1, x) + blur_x(c, y + 2, x)) * 0.333333);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+  blur_x.then(blur_y, computation::root);
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Buffers
+  buffer input_buf("input_buf", {3, 18, 18}, p_float64, a_input);
+  buffer blur_x_buf("blur_x_buf", {3, 18, 16}, p_float64, a_temporary);
+  buffer output_buf("output_buf", {3, 16, 16}, p_float64, a_output);
+
+  // Store inputs
+  input_img.store_in(&input_buf);
+
+  // Store computations
+  blur_x.store_in(&blur_x_buf);
+  blur_y.store_in(&output_buf);
+
+  auto buffers = {&input_buf, &output_buf};
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  auto result = schedule_str_to_result(function_name, schedule, Operation::legality, buffers);
+
+  std::string halide_ir = global::get_implicit_function()->get_halide_ir(buffers);
+
+  return std::tuple<Result, std::string>(result, halide_ir);
+}
+
+TEST(TiraLibCppTest, ComputeAt)
+{
+  // one row of blur_y reads three rows of blur_x
+  std::string schedule = "CA(L1,comps=['blur_x', 'blur_y'])";
+  auto result = apply_schedule_two_stage_blur(schedule);
+
+  Result resultInstance = std::get<0>(result);
+  std::string halide_ir = std::get<1>(result);
+  char *raw_str = isl_union_map_to_str(global::get_implicit_function()->get_dep_read_after_write());
+  std::string scheduled_raw = raw_str;
+  free(raw_str);
+
+  std::string function_name = "function_blur_xy_MINI";
+
+  tiramisu::init(function_name);
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+  var ci("ci", 0, 3), yi("yi", 0, 18), xi("xi", 0, 18);
+  var c("c", 0, 3), y0("y0", 0, 18), x0("x0", 0, 16);
+  var y("y", 0, 16), x("x", 0, 16);
+
+  // inputs
+  input input_img("input_img", {ci, yi, xi}, p_float64);
+
+  // Computations
+  computation blur_x("blur_x", {c, y0, x0}, (input_img(c, y0, x0) + input_img(c, y0, x0 + 1) + input_img(c, y0, x0 + 2)) * 0.333333);
+  computation blur_y("blur_y", {c, y, x}, (blur_x(c, y, x) + blur_x(c, y + 1, x) + blur_x(c, y + 2, x)) * 0.333333);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+  blur_x.then(blur_y, computation::root);
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Buffers
+  buffer input_buf("input_buf", {3, 18, 18}, p_float64, a_input);
+  buffer blur_x_buf("blur_x_buf", {3, 18, 16}, p_float64, a_temporary);
+  buffer output_buf("output_buf", {3, 16, 16}, p_float64, a_output);
+
+  // Store inputs
+  input_img.store_in(&input_buf);
+
+  // Store computations
+  blur_x.store_in(&blur_x_buf);
+  blur_y.store_in(&output_buf);
+
+  auto buffers = {&input_buf, &output_buf};
+
+  // the dependences of the scheduled function are still the ones of the original program
+  prepare_schedules_for_legality_checks();
+  perform_full_dependency_analysis();
+  raw_str = isl_union_map_to_str(global::get_implicit_function()->get_dep_read_after_write());
+  EXPECT_EQ(scheduled_raw, std::string(raw_str));
+  free(raw_str);
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  // the three rows of blur_x read by a row of blur_y are stored in a buffer of 1x3x16 elements
+  blur_x.compute_at(blur_y, 1);
+  buffer blur_x_local("_blur_x_local", {1, 3, 16}, p_float64, a_temporary);
+  blur_x.store_in(&blur_x_local, {c % 1, y0 % 3, x0 % 16});
+  blur_x_local.allocate_at(blur_y, 1)->before(blur_x, 1);
+
+  EXPECT_EQ(resultInstance.legality, true);
+  EXPECT_EQ(resultInstance.additional_info, "compute_at_storage:_blur_x_local:1x3x16");
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
+            clean_halide_ir(halide_ir));
+}
+
+TEST(TiraLibCppTest, ComputeAtSharedProducer)
+{
+  // w also reads A_hat, recomputing it inside the loops of x_temp is rejected
+  std::string schedule = "CA(L0,comps=['A_hat', 'x_temp'])";
+  auto result = apply_schedule_multi_comp_sample(schedule);
+
+  Result resultInstance = std::get<0>(result);
+
+  EXPECT_EQ(resultInstance.additional_info, "compute_at_failed:A_hat");
+  EXPECT_EQ(resultInstance.legality, false);
+}
+
+TEST(TiraLibCppTest, ComputeAtOutputBuffer)
+{
+  // stage1 is an output, it is recomputed at every row of stage2 into its full buffer
+  std::string schedule = "CA(L0,comps=['stage1', 'stage2'])";
+  auto result = apply_schedule_three_stage_sample(schedule);
+
+  Result resultInstance = std::get<0>(result);
+  std::string halide_ir = std::get<1>(result);
+
+  std::string function_name = "function_three_stages_MINI";
+
+  tiramisu::init(function_name);
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+  var i("i", 0, 32), j("j", 0, 32);
+
+  // inputs
+  input input_img("input_img", {i, j}, p_float64);
+
+  // Computations
+  computation stage0("stage0", {i, j}, input_img(i, j) + 1.0);
+  computation stage1("stage1", {i, j}, stage0(i, j) * 2.0);
+  computation stage2("stage2", {i, j}, stage1(i, j) - 3.0);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+  stage0.then(stage1, computation::root).then(stage2, computation::root);
 
   // -------------------------------------------------------
   // Layer III
   // -------------------------------------------------------
-  // Input Buffers
-  buffer b_A("b_A", {40, 40}, p_float64, a_input);
-  buffer b_u1("b_u1", {40}, p_float64, a_input);
-  buffer b_u2("b_u2", {40}, p_float64, a_input);
-  buffer b_v1("b_v1", {40}, p_float64, a_input);
-  buffer b_v2("b_v2", {40}, p_float64, a_input);
-  buffer b_z("b_z", {40}, p_float64, a_input);
-  buffer b_y("b_y", {40}, p_float64, a_input);
-  buffer b_A_hat("b_A_hat", {40, 40}, p_float64, a_output);
-  buffer b_x("b_x", {40}, p_float64, a_output);
-  buffer b_w("b_w", {40}, p_float64, a_output);
+  // Buffers
+  buffer input_buf("input_buf", {32, 32}, p_float64, a_input);
+  buffer stage0_buf("stage0_buf", {32, 32}, p_float64, a_temporary);
+  buffer stage1_buf("stage1_buf", {32, 32}, p_float64, a_output);
+  buffer output_buf("output_buf", {32, 32}, p_float64, a_output);
 
   // Store inputs
-  A.store_in(&b_A);
-  u1.store_in(&b_u1);
-  u2.store_in(&b_u2);
-  v1.store_in(&b_v1);
-  v2.store_in(&b_v2);
-  y.store_in(&b_y);
-  z.store_in(&b_z);
+  input_img.store_in(&input_buf);
 
   // Store computations
-  A_hat.store_in(&b_A_hat);
-  x_temp.store_in(&b_x, {i});
-  x.store_in(&b_x);
-  w.store_in(&b_w, {i});
+  stage0.store_in(&stage0_buf);
+  stage1.store_in(&stage1_buf);
+  stage2.store_in(&output_buf);
 
-  x_temp.interchange(0, 1);
-  A_hat.then(x_temp, 0).then(x, -1).then(w, -1);
+  auto buffers = {&input_buf, &stage1_buf, &output_buf};
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  stage1.compute_at(stage2, 0);
 
   EXPECT_EQ(resultInstance.legality, true);
-  EXPECT_EQ(global::get_implicit_function()->get_name(), "function_gemver_MINI");
-  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir({&b_A, &b_u1, &b_u2, &b_v1, &b_v2, &b_y, &b_z, &b_A_hat, &b_x, &b_w})), clean_halide_ir(halide_ir));
+  EXPECT_EQ(resultInstance.additional_info, "compute_at_storage:full");
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
+            clean_halide_ir(halide_ir));
 }
 
-TEST(TiraLibCppTest, Matrix)
+TEST(TiraLibCppTest, ComputeAtThenParallelization)
 {
-  std::string schedule = "M([0, 1, 0, 1, 0, 0, 0, 0, 1],comps=['comp_blur'])";
+  // the actions after compute_at still see the dependences of blur_x, the channels stay independent
+  auto legal = apply_schedule_two_stage_blur("CA(L1,comps=['blur_x', 'blur_y'])|P(L0,comps=['blur_y'])");
+  EXPECT_EQ(std::get<0>(legal).legality, true);
+}
+
+TEST(TiraLibCppTest, ComputeAtKeepsDependencesIntoProducer)
+{
+  // stage1 is recomputed inside stage2 and reads stage0, so stage2 cannot be moved before stage0
+  std::string schedule = "CA(L0,comps=['stage1', 'stage2'])|Distribute(L0,comps=['stage2', 'stage0'])";
+  auto result = apply_schedule_three_stage_sample(schedule);
+
+  EXPECT_EQ(std::get<0>(result).legality, false);
+}
+
+TEST(TiraLibCppTest, Layout)
+{
+  std::string schedule = "Layout([0, 2, 1],comps=['comp_blur'])";
+  auto result = apply_schedule_blur(schedule);
+
+  Result resultInstance = std::get<0>(result);
+  std::string halide_ir = std::get<1>(result);
+
+  std::string function_name = "function_blur_MINI";
+
+  tiramisu::init(function_name);
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+  var xi("xi", 0, 34), yi("yi", 0, 18), ci("ci", 0, 5);
+  var x("x", 1, 34 - 1), y("y", 1, 18 - 1), c("c", 1, 5 - 1);
+
+  // inputs
+  input input_img("input_img", {ci, yi, xi}, p_float64);
+
+  // Computations
+  computation comp_blur("comp_blur", {c, y, x}, (input_img(c, y + 1, x - 1) + input_img(c, y + 1, x) + input_img(c, y + 1, x + 1) + input_img(c, y, x - 1) + input_img(c, y, x) + input_img(c, y, x + 1) + input_img(c, y - 1, x - 1) + input_img(c, y - 1, x) + input_img(c, y - 1, x + 1)) * 0.111111);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Buffers
+  buffer input_buf("input_buf", {5, 18, 34}, p_float64, a_input);
+  buffer output_buf("output_buf", {5, 18, 34}, p_float64, a_output);
+
+  // Store inputs
+  input_img.store_in(&input_buf);
+
+  auto buffers = {&input_buf, &output_buf};
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  // comp_blur writes to the transposed buffer, only the interior it writes is copied back to output_buf
+  buffer layout_buf("_output_buf_layout", {5, 34, 18}, p_float64, a_temporary);
+  comp_blur.store_in(&layout_buf, {c, x, y});
+
+  var n0("_output_buf_n0", 0, 5), n1("_output_buf_n1", 0, 34), n2("_output_buf_n2", 0, 18);
+  var d0("_output_buf_d0", 1, 4), d1("_output_buf_d1", 1, 17), d2("_output_buf_d2", 1, 33);
+  input layout_view("_output_buf_layout_view", {n0, n1, n2}, p_float64);
+  layout_view.store_in(&layout_buf);
+  computation copy_out("_output_buf_copy_out", {d0, d1, d2}, layout_view(d0, d2, d1));
+  copy_out.store_in(&output_buf);
+  copy_out.after(comp_blur, computation::root);
+
+  EXPECT_EQ(resultInstance.legality, true);
+  EXPECT_EQ(resultInstance.additional_info, "layout:_output_buf_layout:5x34x18");
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
+            clean_halide_ir(halide_ir));
+}
+
+TEST(TiraLibCppTest, LayoutPadding)
+{
+  std::string schedule = "Layout([0, 1, 2],pad=4,comps=['comp_blur'])";
+  auto result = apply_schedule_blur(schedule);
+
+  Result resultInstance = std::get<0>(result);
+
+  EXPECT_EQ(resultInstance.legality, true);
+  EXPECT_EQ(resultInstance.additional_info, "layout:_output_buf_layout:5x18x38");
+}
+
+TEST(TiraLibCppTest, LayoutInputBuffer)
+{
+  std::string schedule = "Layout([1, 0],comps=['A'])";
+  auto result = apply_schedule_multi_comp_sample(schedule);
+
+  Result resultInstance = std::get<0>(result);
+
+  EXPECT_EQ(resultInstance.legality, false);
+}
+
+// comp00 updates buf00 in place through the input icomp00, comp01 is independent from it
+std::tuple<Result, std::string> apply_schedule_in_place_sample(std::string schedule)
+{
+  std::string function_name = "function_in_place_MINI";
+
+  tiramisu::init(function_name);
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+  var i("i", 0, 32), j("j", 0, 32);
+
+  // inputs
+  input icomp00("icomp00", {i, j}, p_float64);
+  input input01("input01", {i, j}, p_float64);
+
+  // Computations
+  computation comp00("comp00", {i, j}, icomp00(i, j) * 2.0);
+  computation comp01("comp01", {i, j}, input01(i, j) + 1.0);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+  comp00.then(comp01, computation::root);
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Buffers
+  buffer buf00("buf00", {32, 32}, p_float64, a_output);
+  buffer input01_buf("input01_buf", {32, 32}, p_float64, a_input);
+  buffer buf01("buf01", {32, 32}, p_float64, a_output);
+
+  // Store inputs
+  icomp00.store_in(&buf00);
+  input01.store_in(&input01_buf);
+
+  // Store computations
+  comp00.store_in(&buf00);
+  comp01.store_in(&buf01);
+
+  auto buffers = {&buf00, &input01_buf, &buf01};
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  auto result = schedule_str_to_result(function_name, schedule, Operation::legality, buffers);
+
+  std::string halide_ir = global::get_implicit_function()->get_halide_ir(buffers);
+
+  return std::tuple<Result, std::string>(result, halide_ir);
+}
+
+TEST(TiraLibCppTest, LayoutInPlaceOutput)
+{
+  // icomp00 reads the values the caller set in buf00, a buffer with another layout would not hold them
+  auto result = apply_schedule_in_place_sample("Layout([1, 0],comps=['comp00'])");
+
+  Result resultInstance = std::get<0>(result);
+
+  EXPECT_EQ(resultInstance.legality, false);
+  EXPECT_EQ(resultInstance.additional_info, "layout_failed:buf00");
+}
+
+TEST(TiraLibCppTest, LayoutAfterDistribution)
+{
+  // comp00 runs after comp01 once distributed, the copy out of buf01 follows it
+  std::string schedule = "Distribute(L0,comps=['comp01', 'comp00'])|Layout([1, 0],comps=['comp01'])";
+  auto result = apply_schedule_in_place_sample(schedule);
+
+  Result resultInstance = std::get<0>(result);
+  std::string halide_ir = std::get<1>(result);
+
+  std::string function_name = "function_in_place_MINI";
+
+  tiramisu::init(function_name);
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+  var i("i", 0, 32), j("j", 0, 32);
+
+  // inputs
+  input icomp00("icomp00", {i, j}, p_float64);
+  input input01("input01", {i, j}, p_float64);
+
+  // Computations
+  computation comp00("comp00", {i, j}, icomp00(i, j) * 2.0);
+  computation comp01("comp01", {i, j}, input01(i, j) + 1.0);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+  comp00.then(comp01, computation::root);
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Buffers
+  buffer buf00("buf00", {32, 32}, p_float64, a_output);
+  buffer input01_buf("input01_buf", {32, 32}, p_float64, a_input);
+  buffer buf01("buf01", {32, 32}, p_float64, a_output);
+
+  // Store inputs
+  icomp00.store_in(&buf00);
+  input01.store_in(&input01_buf);
+
+  // Store computations
+  comp00.store_in(&buf00);
+
+  auto buffers = {&buf00, &input01_buf, &buf01};
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  comp00.after(comp01, computation::root);
+
+  buffer layout_buf("_buf01_layout", {32, 32}, p_float64, a_temporary);
+  comp01.store_in(&layout_buf, {j, i});
+  var n0("_buf01_n0", 0, 32), n1("_buf01_n1", 0, 32);
+  var d0("_buf01_d0", 0, 32), d1("_buf01_d1", 0, 32);
+  input layout_view("_buf01_layout_view", {n0, n1}, p_float64);
+  layout_view.store_in(&layout_buf);
+  computation copy_out("_buf01_copy_out", {d0, d1}, layout_view(d1, d0));
+  copy_out.store_in(&buf01);
+  copy_out.after(comp00, computation::root);
+
+  EXPECT_EQ(resultInstance.legality, true);
+  EXPECT_EQ(resultInstance.additional_info, "layout:_buf01_layout:32x32");
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
+            clean_halide_ir(halide_ir));
+}
+
+TEST(TiraLibCppTest, Shifting)
+{
+  std::string schedule = "Shift(L2,2,comps=['comp_blur'])";
   auto result = apply_schedule_blur(schedule);
 
   Result resultInstance = std::get<0>(result);
@@ -792,9 +1871,101 @@ TEST(TiraLibCppTest, Matrix)
   // -------------------------------------------------------
   // Code Generation
   // -------------------------------------------------------
-  comp_blur.matrix_transform({{0, 1, 0}, {1, 0, 0}, {0, 0, 1}});
+  comp_blur.shift(x, 2);
 
+  EXPECT_EQ(resultInstance.legality, true);
   EXPECT_EQ(global::get_implicit_function()->get_name(), function_name);
   EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
             clean_halide_ir(halide_ir));
 }
+
+TEST(TiraLibCppTest, DistributionAfterFusion)
+{
+  std::string schedule = "I(L0,L1,comps=['x_temp'])|F(L0,comps=['A_hat', 'x_temp'])|Distribute(L0,comps=['A_hat', 'x_temp'])";
+  auto result = apply_schedule_multi_comp_sample(schedule);
+
+  Result resultInstance = std::get<0>(result);
+
+  EXPECT_EQ(resultInstance.legality, true);
+}
+
+TEST(TiraLibCppTest, DistributionSharedLoopNest)
+{
+  // the three stages start in the same loop nest, stage1 and stage2 only keep the loop over i in common
+  std::string schedule = "Distribute(L1,comps=['stage1', 'stage2'])";
+  auto result = apply_schedule_three_stage_sample(schedule, true);
+
+  Result resultInstance = std::get<0>(result);
+  std::string halide_ir = std::get<1>(result);
+
+  std::string function_name = "function_three_stages_MINI";
+
+  tiramisu::init(function_name);
+
+  // -------------------------------------------------------
+  // Layer I
+  // -------------------------------------------------------
+  var i("i", 0, 32), j("j", 0, 32);
+
+  // inputs
+  input input_img("input_img", {i, j}, p_float64);
+
+  // Computations
+  computation stage0("stage0", {i, j}, input_img(i, j) + 1.0);
+  computation stage1("stage1", {i, j}, stage0(i, j) * 2.0);
+  computation stage2("stage2", {i, j}, stage1(i, j) - 3.0);
+
+  // -------------------------------------------------------
+  // Layer II
+  // -------------------------------------------------------
+  stage0.then(stage1, 1).then(stage2, 1);
+
+  // -------------------------------------------------------
+  // Layer III
+  // -------------------------------------------------------
+  // Buffers
+  buffer input_buf("input_buf", {32, 32}, p_float64, a_input);
+  buffer stage0_buf("stage0_buf", {32, 32}, p_float64, a_temporary);
+  buffer stage1_buf("stage1_buf", {32, 32}, p_float64, a_output);
+  buffer output_buf("output_buf", {32, 32}, p_float64, a_output);
+
+  // Store inputs
+  input_img.store_in(&input_buf);
+
+  // Store computations
+  stage0.store_in(&stage0_buf);
+  stage1.store_in(&stage1_buf);
+  stage2.store_in(&output_buf);
+
+  auto buffers = {&input_buf, &stage1_buf, &output_buf};
+
+  // -------------------------------------------------------
+  // Code Generation
+  // -------------------------------------------------------
+  stage2.after(stage1, 0);
+
+  EXPECT_EQ(resultInstance.legality, true);
+  EXPECT_EQ(clean_halide_ir(global::get_implicit_function()->get_halide_ir(buffers)),
+            clean_halide_ir(halide_ir));
+}
+
+TEST(TiraLibCppTest, DistributionSingleComputation)
+{
+  std::string schedule = "Distribute(L0,comps=['A_hat'])";
+
+  EXPECT_THROW(apply_schedule_multi_comp_sample(schedule), std::invalid_argument);
+}
+
+TEST(TiraLibCppTest, SkewingSolverOperation)
+{
+  auto result = apply_schedule_skewing_sample("", Operation::skewing_solver);
+
+  Result resultInstance = std::get<0>(result);
+
+  EXPECT_EQ(resultInstance.legality, true);
+  EXPECT_NE(resultInstance.skewing_candidates.find("{\"comps\": [\"comp00\"], \"levels\": [0, 1]"), std::string::npos);
+  EXPECT_NE(resultInstance.skewing_candidates.find("{\"comps\": [\"comp00\"], \"levels\": [1, 2]"), std::string::npos);
+  // the factors picked by S(L0,L1,0,0) are among the candidates
+  EXPECT_NE(resultInstance.skewing_candidates.find("[1, 1]"), std::string::npos);
+  EXPECT_EQ(deserialize_result(serialize_result(resultInstance)).skewing_candidates, resultInstance.skewing_candidates);
+}
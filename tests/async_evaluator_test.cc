@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <TiraLibCPP/async_evaluator.h>
+
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+// a fake generated executable that sleeps for the number of seconds given as schedule and echoes it as exec_times
+std::string make_sleeping_executable(std::string test_name)
+{
+  std::string root = std::filesystem::temp_directory_path().string() + "/tiralib_" + test_name + "_" + std::to_string(getpid());
+  std::filesystem::remove_all(root);
+  std::filesystem::create_directories(root);
+
+  std::string executable = root + "/function_fake";
+  std::ofstream script(executable);
+  script << "#!/bin/sh\n";
+  script << "sleep $2\n";
+  script << "echo \"{\\\"name\\\": \\\"function_fake\\\",\\\"legality\\\": 1,\\\"isl_ast\\\": \\\"\\\",\\\"exec_times\\\": \\\"$2\\\",\\\"success\\\": 1,\\\"additional_info\\\": \\\"\\\"}\"\n";
+  script.close();
+  std::filesystem::permissions(executable, std::filesystem::perms::owner_all);
+  return executable;
+}
+
+TEST(AsyncEvaluatorTest, SubmitAndWait)
+{
+  std::string executable = make_sleeping_executable("submit");
+  AsyncEvaluator evaluator(executable, 4, std::filesystem::path(executable).parent_path().string());
+
+  std::vector<AsyncRequest> requests;
+  for (int i = 0; i < 4; i++)
+    requests.push_back(evaluator.submit("0", Operation::legality));
+
+  for (auto &request : requests)
+  {
+    Result result = request.future.get();
+    EXPECT_TRUE(result.success);
+    EXPECT_TRUE(result.legality);
+    EXPECT_EQ(result.exec_times, "0");
+  }
+  EXPECT_EQ(evaluator.in_flight(), 0);
+}
+
+TEST(AsyncEvaluatorTest, Backpressure)
+{
+  std::string executable = make_sleeping_executable("backpressure");
+  AsyncEvaluator evaluator(executable, 1, std::filesystem::path(executable).parent_path().string());
+
+  AsyncRequest first = evaluator.submit("1", Operation::legality);
+  AsyncRequest second;
+  EXPECT_FALSE(evaluator.try_submit("0", Operation::legality, second));
+  EXPECT_TRUE(first.future.get().success);
+  EXPECT_TRUE(evaluator.try_submit("0", Operation::legality, second));
+  EXPECT_TRUE(second.future.get().success);
+}
+
+TEST(AsyncEvaluatorTest, Cancel)
+{
+  std::string executable = make_sleeping_executable("cancel");
+  AsyncEvaluator evaluator(executable, 2, std::filesystem::path(executable).parent_path().string());
+
+  AsyncRequest request = evaluator.submit("30", Operation::execution);
+  EXPECT_TRUE(evaluator.cancel(request.id));
+
+  Result result = request.future.get();
+  EXPECT_FALSE(result.success);
+  EXPECT_EQ(result.additional_info, "cancelled");
+  EXPECT_FALSE(evaluator.cancel(request.id));
+}
@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+#include <TiraLibCPP/canonicalization.h>
+
+TEST(CanonicalizationTest, NormalizesFormatting)
+{
+  EXPECT_EQ(canonicalize_schedule_str("P( L0, comps=[ 'comp_blur' ] )"), "P(L0,comps=['comp_blur'])");
+  EXPECT_EQ(canonicalize_schedule_str("M([0, 1, 0, 1, 0, 0, 0, 0, 1],comps=['comp_blur'])"), "M([0,1,0,1,0,0,0,0,1],comps=['comp_blur'])");
+}
+
+TEST(CanonicalizationTest, SortsUnorderedComps)
+{
+  EXPECT_EQ(canonicalize_schedule_str("I(L0,L1,comps=['w', 'A_hat'])"), "I(L0,L1,comps=['A_hat','w'])");
+  EXPECT_EQ(canonicalize_schedule_str("R(L0,comps=['x','A_hat'])"), canonicalize_schedule_str("R(L0,comps=['A_hat', 'x'])"));
+}
+
+TEST(CanonicalizationTest, KeepsOrderedComps)
+{
+  EXPECT_EQ(canonicalize_schedule_str("F(L0,comps=['x_temp', 'A_hat'])"), "F(L0,comps=['x_temp','A_hat'])");
+  EXPECT_EQ(canonicalize_schedule_str("T2(L0,L1,32,32,comps=['w','A_hat'])"), "T2(L0,L1,32,32,comps=['w','A_hat'])");
+  EXPECT_EQ(canonicalize_schedule_str("Distribute(L1,comps=['x_temp', 'A_hat'])"), "Distribute(L1,comps=['x_temp','A_hat'])");
+  // P tags the first computation, U and V use its loop
+  EXPECT_EQ(canonicalize_schedule_str("P(L0,comps=['w', 'A_hat'])"), "P(L0,comps=['w','A_hat'])");
+  EXPECT_EQ(canonicalize_schedule_str("U(L1,4,comps=['w', 'A_hat'])"), "U(L1,4,comps=['w','A_hat'])");
+  EXPECT_EQ(canonicalize_schedule_str("V(L1,8,comps=['w', 'A_hat'])"), "V(L1,8,comps=['w','A_hat'])");
+}
+
+TEST(CanonicalizationTest, DropsNoOps)
+{
+  // unrolling by 1 still has its legality checked
+  EXPECT_EQ(canonicalize_schedule_str("U(L2,1,comps=['comp_blur'])"), "U(L2,1,comps=['comp_blur'])");
+  EXPECT_EQ(canonicalize_schedule_str("I(L1,L1,comps=['comp_blur'])|P(L0,comps=['comp_blur'])"), "P(L0,comps=['comp_blur'])");
+  EXPECT_EQ(canonicalize_schedule_str("M([1, 0, 0, 1],comps=['comp_blur'])"), "");
+  EXPECT_EQ(canonicalize_schedule_str("Layout([0, 1, 2],comps=['comp_blur'])"), "");
+  EXPECT_EQ(canonicalize_schedule_str("Shift(L1,0,comps=['comp_blur'])"), "");
+  EXPECT_EQ(canonicalize_schedule_str("Layout([0, 1, 2],pad=8,comps=['comp_blur'])"), "Layout([0,1,2],pad=8,comps=['comp_blur'])");
+}
+
+TEST(CanonicalizationTest, CancelsInvolutions)
+{
+  EXPECT_EQ(canonicalize_schedule_str("I(L0,L1,comps=['comp_blur'])|I(L1,L0,comps=['comp_blur'])"), "");
+  EXPECT_EQ(canonicalize_schedule_str("I(L0,L1,comps=['comp_blur'])|R(L2,comps=['comp_blur'])|R(L2,comps=['comp_blur'])|I(L0,L1,comps=['comp_blur'])|P(L0,comps=['comp_blur'])"), "P(L0,comps=['comp_blur'])");
+  EXPECT_EQ(canonicalize_schedule_str("R(L0,comps=['comp_blur'])|R(L1,comps=['comp_blur'])"), "R(L0,comps=['comp_blur'])|R(L1,comps=['comp_blur'])");
+}
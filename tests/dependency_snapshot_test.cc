@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <tiramisu/tiramisu.h>
+#include <TiraLibCPP/dependency_snapshot.h>
+
+#include <isl/union_map.h>
+
+#include <cstdlib>
+
+using namespace tiramisu;
+
+static std::string to_str(isl_union_map *map)
+{
+  char *str = isl_union_map_to_str(map);
+  std::string result = str == nullptr ? "" : str;
+  free(str);
+  return result;
+}
+
+// comp_scale reads the output of comp_shift, both in their own loop nest or fused in one
+static std::string build_two_stages(bool fused, int size = 32)
+{
+  tiramisu::init("function_two_stages");
+  var i("i", 0, size), j("j", 0, size);
+  input input_img("input_img", {i, j}, p_float64);
+  computation comp_shift("comp_shift", {i, j}, input_img(i, j) + 1.0);
+  computation comp_scale("comp_scale", {i, j}, comp_shift(i, j) * 2.0);
+  comp_shift.then(comp_scale, fused ? 1 : computation::root);
+
+  buffer input_buf("input_buf", {size, size}, p_float64, a_input);
+  buffer shift_buf("shift_buf", {size, size}, p_float64, a_temporary);
+  buffer output_buf("output_buf", {size, size}, p_float64, a_output);
+  input_img.store_in(&input_buf);
+  comp_shift.store_in(&shift_buf);
+  comp_scale.store_in(&output_buf);
+
+  prepare_schedules_for_legality_checks();
+  return get_function_source_hash(global::get_implicit_function());
+}
+
+TEST(DependencySnapshotTest, SaveLoadRoundTrip)
+{
+  std::string snapshot_path = "/tmp/tiralib_test_deps.txt";
+  std::string function_hash = build_two_stages(false);
+  perform_full_dependency_analysis();
+  std::string raw = to_str(global::get_implicit_function()->get_dep_read_after_write());
+  ASSERT_TRUE(save_dependency_snapshot(snapshot_path, function_hash, global::get_implicit_function()));
+
+  EXPECT_EQ(build_two_stages(false), function_hash);
+  EXPECT_TRUE(load_dependency_snapshot(snapshot_path, function_hash, global::get_implicit_function()));
+  EXPECT_EQ(to_str(global::get_implicit_function()->get_dep_read_after_write()), raw);
+  EXPECT_FALSE(raw.empty());
+}
+
+TEST(DependencySnapshotTest, HashMismatch)
+{
+  std::string snapshot_path = "/tmp/tiralib_test_deps_mismatch.txt";
+  std::string function_hash = build_two_stages(false);
+  perform_full_dependency_analysis();
+  ASSERT_TRUE(save_dependency_snapshot(snapshot_path, function_hash, global::get_implicit_function()));
+
+  std::string other_hash = build_two_stages(false, 64);
+
+  EXPECT_NE(other_hash, function_hash);
+  EXPECT_FALSE(load_dependency_snapshot(snapshot_path, other_hash, global::get_implicit_function()));
+  EXPECT_FALSE(load_dependency_snapshot("/tmp/tiralib_test_deps_missing.txt", function_hash, global::get_implicit_function()));
+}
+
+TEST(DependencySnapshotTest, ReorderedProgramDoesNotReuseSnapshot)
+{
+  setenv("TIRAMISU_DEPS_CACHE_DIR", "/tmp", 1);
+  std::string separate_hash = build_two_stages(false);
+  perform_dependency_analysis_with_snapshot("function_two_stages", global::get_implicit_function());
+
+  std::string fused_hash = build_two_stages(true);
+
+  // the computations only differ by their ordering
+  EXPECT_NE(fused_hash, separate_hash);
+  EXPECT_FALSE(load_dependency_snapshot("/tmp/function_two_stages_deps.txt", fused_hash, global::get_implicit_function()));
+
+  // the analysis of the fused program is not the one of the separate loop nests
+  perform_dependency_analysis_with_snapshot("function_two_stages", global::get_implicit_function());
+  std::string fused_raw = to_str(global::get_implicit_function()->get_dep_read_after_write());
+  perform_full_dependency_analysis();
+  EXPECT_EQ(fused_raw, to_str(global::get_implicit_function()->get_dep_read_after_write()));
+
+  unsetenv("TIRAMISU_DEPS_CACHE_DIR");
+}
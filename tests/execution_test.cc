@@ -0,0 +1,438 @@
+#include <gtest/gtest.h>
+#include <tiramisu/tiramisu.h>
+#include <TiraLibCPP/cpu_topology.h>
+#include <TiraLibCPP/execution.h>
+#include <TiraLibCPP/roofline.h>
+#include <TiraLibCPP/wrapper_runtime.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+
+using namespace tiramisu;
+
+static std::string write_script(std::string name, std::string body)
+{
+  std::string path = "/tmp/" + name;
+  std::ofstream(path) << "#!/bin/sh\n"
+                      << body;
+  chmod(path.c_str(), 0755);
+  return path;
+}
+
+TEST(ExecutionTest, GenerateWrapperSource)
+{
+  tiramisu::init("function_blur_MINI");
+  buffer input_buf("input_buf", {5, 18, 34}, p_float64, a_input);
+  buffer output_buf("output_buf", {5, 18, 34}, p_float64, a_output);
+
+  std::string source = generate_wrapper_source("function_blur_MINI", {&input_buf, &output_buf});
+
+  EXPECT_NE(source.find("extern \"C\" int function_blur_MINI(halide_buffer_t *, halide_buffer_t *);"), std::string::npos);
+  EXPECT_NE(source.find("tiralib::Buffer<double> buf_input_buf(\"input_buf\", {5, 18, 34});"), std::string::npos);
+  EXPECT_NE(source.find("function_blur_MINI(buf_input_buf.raw(), buf_output_buf.raw())"), std::string::npos);
+}
+
+TEST(ExecutionTest, GenerateParametricWrapperSource)
+{
+  tiramisu::init("function_parametric");
+  var N("N"), M("M");
+  buffer sizes_buf("SIZES", {2}, p_int32, a_input);
+  buffer input_buf("input_buf", {N, M + 2}, p_float64, a_input);
+  buffer output_buf("output_buf", {N, M}, p_float64, a_output);
+
+  std::string source = generate_wrapper_source("function_parametric", {&sizes_buf, &input_buf, &output_buf});
+
+  EXPECT_TRUE(is_parametric({&sizes_buf, &input_buf, &output_buf}));
+  EXPECT_FALSE(is_parametric({&sizes_buf}));
+  EXPECT_NE(source.find("int32_t param_M = tiralib::get_size(size, \"M\");"), std::string::npos);
+  EXPECT_NE(source.find("tiralib::Buffer<double> buf_input_buf(\"input_buf\", {param_N, (param_M + 2)});"), std::string::npos);
+  EXPECT_NE(source.find("tiralib::set_size_values(buf_SIZES.raw(), size, {\"M\", \"N\"});"), std::string::npos);
+}
+
+TEST(ExecutionTest, OperationCounts)
+{
+  tiramisu::init("function_roofline");
+  var i("i", 0, 64), j("j", 0, 32);
+  input A("A", {i, j}, p_float64);
+  computation B("B", {i, j}, (A(i, j) + A(i, j) * 2.0) / 3.0);
+  buffer a_buf("a_buf", {64, 32}, p_float64, a_input);
+  buffer b_buf("b_buf", {64, 32}, p_float64, a_output);
+  A.store_in(&a_buf);
+  B.store_in(&b_buf);
+
+  OperationCounts counts = get_operation_counts(tiramisu::global::get_implicit_function());
+
+  EXPECT_EQ(count_operations(B.get_expr()), 3);
+  ASSERT_EQ(counts.computations.size(), 1);
+  EXPECT_EQ(counts.computations[0].points, 64 * 32);
+  EXPECT_EQ(counts.operations, 3 * 64 * 32);
+  EXPECT_EQ(counts.computations[0].bytes_read, 64 * 32 * 8);
+  EXPECT_EQ(counts.compulsory_bytes, 2 * 64 * 32 * 8);
+  EXPECT_TRUE(counts.exact);
+}
+
+TEST(ExecutionTest, OperationCountsSeveralComputations)
+{
+  tiramisu::init("function_roofline_stages");
+  var i("i", 0, 64), j("j", 0, 32);
+  input A("A", {i, j}, p_float64);
+  computation B("B", {i, j}, A(i, j) * 2.0);
+  computation C("C", {i, j}, B(i, j) + A(i, j));
+  computation D("D", {i, j}, C(i, j) * 3.0);
+  buffer a_buf("a_buf", {64, 32}, p_float64, a_input);
+  buffer b_buf("b_buf", {64, 32}, p_float64, a_temporary);
+  buffer c_buf("c_buf", {64, 32}, p_float64, a_output);
+  buffer d_buf("d_buf", {64, 32}, p_float64, a_output);
+  A.store_in(&a_buf);
+  B.store_in(&b_buf);
+  C.store_in(&c_buf);
+  D.store_in(&d_buf);
+
+  OperationCounts counts = get_operation_counts(tiramisu::global::get_implicit_function());
+
+  ASSERT_EQ(counts.computations.size(), 3);
+  EXPECT_EQ(counts.computations[2].bytes_read, 64 * 32 * 8);
+  // a_buf is loaded and c_buf and d_buf are stored, the temporary b_buf and the reads of c_buf written by C are not counted
+  EXPECT_EQ(counts.compulsory_bytes, 3 * 64 * 32 * 8);
+  EXPECT_TRUE(counts.exact);
+}
+
+TEST(ExecutionTest, RunWrapperReadsReport)
+{
+  std::string wrapper = write_script("tiralib_test_wrapper", "echo \"exec_times 1.5 2.5\" > \"$TIRAMISU_REPORT_FILE\"\necho \"$TIRAMISU_NB_EXEC\"\n");
+  ExecutionOptions options;
+  options.nb_exec = 3;
+
+  auto run = run_wrapper(wrapper, options);
+
+  EXPECT_TRUE(run.success);
+  EXPECT_EQ(run.output, "3\n");
+  EXPECT_EQ(run.report["exec_times"], "1.5 2.5");
+}
+
+TEST(ExecutionTest, RunWrapperFailure)
+{
+  std::string wrapper = write_script("tiralib_test_failing_wrapper", "exit 3\n");
+
+  auto run = run_wrapper(wrapper, ExecutionOptions());
+
+  EXPECT_FALSE(run.success);
+  EXPECT_TRUE(run.report.empty());
+}
+
+TEST(ExecutionTest, MeasureWithPerfCounters)
+{
+  std::string report_path = "/tmp/tiralib_test_report.txt";
+  setenv("TIRAMISU_REPORT_FILE", report_path.c_str(), 1);
+  setenv("TIRAMISU_NB_EXEC", "3", 1);
+  setenv("TIRAMISU_PERF_COUNTERS", "1", 1);
+
+  tiralib::Buffer<double> buffer("buffer", {64, 64});
+  double sum = 0;
+  int status = tiralib::measure([&]()
+                                {
+                                  double *data = (double *)buffer.raw()->host;
+                                  for (int i = 0; i < 64 * 64; i++)
+                                    sum += data[i];
+                                  return 0; });
+  auto report = read_report(report_path);
+
+  EXPECT_EQ(status, 0);
+  EXPECT_GT(sum, 0);
+  EXPECT_EQ(parse_exec_times(report["exec_times"]).size(), 3);
+  // counters are optional (e.g. in containers), otherwise they are read around one untimed run
+  std::string counters = report["perf_counters"];
+  EXPECT_TRUE(counters == "[]" || std::count(counters.begin(), counters.end(), '{') == 1);
+
+  unsetenv("TIRAMISU_REPORT_FILE");
+  unsetenv("TIRAMISU_NB_EXEC");
+  unsetenv("TIRAMISU_PERF_COUNTERS");
+}
+
+// two packages with two cores of two SMT threads each, one NUMA node per package
+static std::string write_fake_sysfs()
+{
+  std::string root = "/tmp/tiralib_test_sysfs";
+  system(("rm -rf " + root).c_str());
+  std::vector<std::vector<int>> node_cpus = {{0, 1, 4, 5}, {2, 3, 6, 7}};
+  for (int cpu = 0; cpu < 8; cpu++)
+  {
+    std::string topology = root + "/cpu/cpu" + std::to_string(cpu) + "/topology";
+    system(("mkdir -p " + topology).c_str());
+    std::ofstream(topology + "/core_id") << (cpu % 4) / 2 * 4 + cpu % 2 << "\n";
+    std::ofstream(topology + "/physical_package_id") << (cpu % 4) / 2 << "\n";
+  }
+  std::ofstream(root + "/cpu/online") << "0-7\n";
+  system(("mkdir -p " + root + "/node/node0 " + root + "/node/node1").c_str());
+  std::ofstream(root + "/node/online") << "0-1\n";
+  std::ofstream(root + "/node/node0/cpulist") << "0-1,4-5\n";
+  std::ofstream(root + "/node/node1/cpulist") << "2-3,6-7\n";
+  return root;
+}
+
+TEST(ExecutionTest, CPUTopology)
+{
+  auto cpus = get_cpu_topology(write_fake_sysfs());
+
+  ASSERT_EQ(cpus.size(), 8);
+  EXPECT_EQ(parse_cpu_list("0-2,5"), std::vector<int>({0, 1, 2, 5}));
+  EXPECT_EQ(cpus[6].node, 1);
+  EXPECT_EQ(cpus[4].thread, 1);
+  EXPECT_EQ(get_affinity_cpus(cpus, 2, "compact"), std::vector<int>({0, 4}));
+  EXPECT_EQ(get_affinity_cpus(cpus, 4, "scatter"), std::vector<int>({0, 2, 1, 3}));
+  EXPECT_EQ(get_affinity_cpus(cpus, 3, "numa"), std::vector<int>({0, 1, 4}));
+  EXPECT_TRUE(get_affinity_cpus(cpus, 5, "numa").empty());
+  EXPECT_THROW(get_affinity_cpus(cpus, 2, "unknown"), std::invalid_argument);
+}
+
+TEST(ExecutionTest, ThreadSweep)
+{
+  std::string wrapper = write_script("tiralib_test_threads_wrapper", "echo \"exec_times $HL_NUM_THREADS\" > \"$TIRAMISU_REPORT_FILE\"\n");
+  ExecutionOptions options;
+  options.thread_counts = {1};
+  Result result;
+
+  std::string sweep = run_thread_sweep(wrapper, options, get_allowed_cpus(), result);
+
+  EXPECT_NE(sweep.find("\"threads\": 1, \"affinity\": \"compact\""), std::string::npos);
+  EXPECT_NE(sweep.find("\"efficiency\": 1.000000"), std::string::npos);
+}
+
+TEST(ExecutionTest, PartitionCPUs)
+{
+  auto cpus = get_cpu_topology(write_fake_sysfs());
+
+  EXPECT_EQ(partition_cpus(cpus, 1), std::vector<std::vector<int>>({{0, 1, 2, 3, 4, 5, 6, 7}}));
+  EXPECT_EQ(partition_cpus(cpus, 2), std::vector<std::vector<int>>({{0, 1, 4, 5}, {2, 3, 6, 7}}));
+  EXPECT_EQ(partition_cpus(cpus, 4), std::vector<std::vector<int>>({{0, 4}, {1, 5}, {2, 6}, {3, 7}}));
+  EXPECT_EQ(partition_cpus(cpus, 3).size(), 3);
+  EXPECT_THROW(partition_cpus(cpus, 5), std::invalid_argument);
+}
+
+TEST(ExecutionTest, MeasurementSlot)
+{
+  ExecutionOptions options;
+  options.measurement_slots = 1;
+  options.slot_lock_dir = "/tmp/tiralib_test_slots";
+
+  for (int i = 0; i < 2; i++)
+  {
+    // the slot is released when it is destroyed, so the second iteration does not wait
+    MeasurementSlot slot(options);
+    EXPECT_EQ(slot.index, 0);
+    EXPECT_EQ(slot.get_placement().cpus.size(), get_allowed_cpus().size());
+  }
+}
+
+TEST(ExecutionTest, ResourceUsage)
+{
+  std::string wrapper = write_script("tiralib_test_busy_wrapper", "i=0\nwhile [ $i -lt 20000 ]; do i=$((i+1)); done\n");
+  Result result;
+
+  set_resource_usage(run_wrapper(wrapper, ExecutionOptions()), result);
+  Result deserialized = deserialize_result(serialize_result(result));
+
+  EXPECT_GT(result.max_rss_kb, 0);
+  EXPECT_GT(result.minor_page_faults, 0);
+  EXPECT_GT(result.user_time + result.system_time, 0);
+  EXPECT_EQ(deserialized.max_rss_kb, result.max_rss_kb);
+  EXPECT_EQ(deserialized.minor_page_faults, result.minor_page_faults);
+}
+
+TEST(ExecutionTest, CacheModes)
+{
+  std::string report_path = "/tmp/tiralib_test_cache_report.txt";
+  setenv("TIRAMISU_REPORT_FILE", report_path.c_str(), 1);
+  setenv("TIRAMISU_NB_EXEC", "2", 1);
+  int nb_calls = 0;
+  auto kernel = [&]()
+  {
+    nb_calls++;
+    return 0;
+  };
+
+  // the warm mode runs the kernel once before timing it
+  setenv("TIRAMISU_CACHE_MODE", "warm", 1);
+  tiralib::measure(kernel);
+  EXPECT_EQ(nb_calls, 3);
+  EXPECT_EQ(read_report(report_path)["cache_mode"], "warm");
+
+  setenv("TIRAMISU_CACHE_MODE", "cold", 1);
+  tiralib::measure(kernel);
+  auto report = read_report(report_path);
+  EXPECT_EQ(nb_calls, 5);
+  EXPECT_EQ(report["cache_mode"], "cold");
+  EXPECT_EQ(std::stoull(report["cache_flush_bytes"]), 2 * tiralib::get_llc_size());
+  EXPECT_GT(tiralib::get_llc_size(), 0);
+
+  unsetenv("TIRAMISU_REPORT_FILE");
+  unsetenv("TIRAMISU_NB_EXEC");
+  unsetenv("TIRAMISU_CACHE_MODE");
+}
+
+TEST(ExecutionTest, BufferAllocation)
+{
+  setenv("HL_NUM_THREADS", "3", 1);
+
+  // the options are read from the environment once per wrapper
+  tiralib::get_allocation_options() = tiralib::AllocationOptions();
+  tiralib::get_allocation_options().hugepages = "transparent";
+  tiralib::get_allocation_options().numa = "first_touch";
+  tiralib::Buffer<double> parallel_buffer("buffer", {100, 37});
+  tiralib::get_allocation_options().numa = "default";
+  tiralib::Buffer<double> sequential_buffer("buffer", {100, 37});
+  tiralib::Buffer<double> other_buffer("other_buffer", {100, 37});
+
+  double *parallel_data = (double *)parallel_buffer.raw()->host;
+  double *sequential_data = (double *)sequential_buffer.raw()->host;
+  double *other_data = (double *)other_buffer.raw()->host;
+  EXPECT_EQ((uintptr_t)parallel_data % (1 << 21), 0);
+  EXPECT_TRUE(std::equal(parallel_data, parallel_data + 3700, sequential_data));
+  EXPECT_FALSE(std::equal(parallel_data, parallel_data + 3700, other_data));
+  EXPECT_EQ(parallel_buffer.raw()->dim[0].extent, 37);
+  EXPECT_EQ(parallel_buffer.raw()->dim[1].stride, 37);
+  EXPECT_NE(tiralib::get_allocation_options().describe().find("hugepages=transparent;numa=default;fill=random:0"), std::string::npos);
+
+  tiralib::get_allocation_options() = tiralib::AllocationOptions();
+  unsetenv("HL_NUM_THREADS");
+}
+
+TEST(ExecutionTest, ValidateOutputs)
+{
+  std::string report_path = "/tmp/tiralib_test_validation_report.txt";
+  std::string reference_path = "/tmp/tiralib_test_reference.bin";
+  setenv("TIRAMISU_REPORT_FILE", report_path.c_str(), 1);
+  setenv("TIRAMISU_NB_EXEC", "2", 1);
+  tiralib::Buffer<double> input("input", {1000});
+  tiralib::Buffer<double> output("output", {1000}, true);
+  double *input_data = (double *)input.raw()->host;
+  double *output_data = (double *)output.raw()->host;
+  double scale = 2;
+  // accumulates into its output, the comparison happens after the first run
+  auto kernel = [&]()
+  {
+    for (int i = 0; i < 1000; i++)
+      output_data[i] += scale * input_data[i];
+    return 0;
+  };
+  std::vector<double> initial_output(output_data, output_data + 1000);
+
+  setenv("TIRAMISU_RECORD_REFERENCE", reference_path.c_str(), 1);
+  tiralib::measure(kernel);
+  std::string checksum = read_report(report_path)["output_checksum"];
+  unsetenv("TIRAMISU_RECORD_REFERENCE");
+
+  setenv("TIRAMISU_VALIDATE_REFERENCE", reference_path.c_str(), 1);
+  std::copy(initial_output.begin(), initial_output.end(), output_data);
+  scale = 2 * (1 + 1e-9);
+  tiralib::measure(kernel);
+  auto report = read_report(report_path);
+  EXPECT_EQ(report["validation_passed"], "1");
+  EXPECT_GT(std::stod(report["validation_max_abs_error"]), 0);
+
+  std::copy(initial_output.begin(), initial_output.end(), output_data);
+  scale = 3;
+  tiralib::measure(kernel);
+  report = read_report(report_path);
+  EXPECT_EQ(report["validation_passed"], "0");
+  EXPECT_NE(report["output_checksum"], checksum);
+
+  unsetenv("TIRAMISU_VALIDATE_REFERENCE");
+  unsetenv("TIRAMISU_REPORT_FILE");
+  unsetenv("TIRAMISU_NB_EXEC");
+}
+
+TEST(ExecutionTest, MeasureVariants)
+{
+  std::string report_path = "/tmp/tiralib_test_variants_report.txt";
+  setenv("TIRAMISU_REPORT_FILE", report_path.c_str(), 1);
+  setenv("TIRAMISU_NB_EXEC", "2", 1);
+  std::ofstream("/tmp/tiralib_test_variant.c") << "int kernel(double *data, int n) { for (int i = 0; i < n; i++) data[i] += 1; return 0; }\n";
+  ASSERT_EQ(system("cc -shared -fPIC -o /tmp/tiralib_test_variant.so /tmp/tiralib_test_variant.c"), 0);
+
+  tiralib::Buffer<double> buffer("buffer", {100});
+  double *data = (double *)buffer.raw()->host;
+  double initial_value = data[0];
+  int nb_initial_calls = 0;
+  int status = tiralib::measure_variants({"/tmp/tiralib_test_variant.so", "/tmp/tiralib_test_missing.so", "/tmp/tiralib_test_variant.so"}, "kernel", [&](void *kernel)
+                                         {
+                                           nb_initial_calls += data[0] == initial_value;
+                                           return ((int (*)(double *, int))kernel)(data, 100); });
+  auto report = read_report(report_path);
+
+  EXPECT_EQ(status, 0);
+  EXPECT_EQ(report["nb_variants"], "3");
+  EXPECT_EQ(parse_exec_times(report["variant_0_exec_times"]).size(), 2);
+  EXPECT_EQ(report["variant_1_error"], "not_loaded");
+  EXPECT_EQ(parse_exec_times(report["variant_2_exec_times"]).size(), 2);
+  // the buffers are filled again before every variant
+  EXPECT_EQ(nb_initial_calls, 2);
+  EXPECT_EQ(data[0], initial_value + 3);
+
+  unsetenv("TIRAMISU_REPORT_FILE");
+  unsetenv("TIRAMISU_NB_EXEC");
+}
+
+TEST(ExecutionTest, MeasureProblemSizes)
+{
+  std::string report_path = "/tmp/tiralib_test_sizes_report.txt";
+  setenv("TIRAMISU_REPORT_FILE", report_path.c_str(), 1);
+  setenv("TIRAMISU_NB_EXEC", "2", 1);
+  // the second size lists its parameters in another order
+  setenv("TIRAMISU_PROBLEM_SIZES", "N=10,M=3;M=5,N=20", 1);
+  std::vector<int> nb_elements;
+
+  int status = tiralib::measure_problem_sizes([&](const tiralib::ProblemSize &size, tiralib::Measurement measure)
+                                              {
+                                                tiralib::Buffer<int32_t> sizes("SIZES", {2});
+                                                tiralib::Buffer<double> buffer("buffer", {tiralib::get_size(size, "N"), tiralib::get_size(size, "M")});
+                                                tiralib::set_size_values(sizes.raw(), size, {"M", "N"});
+                                                int32_t *values = (int32_t *)sizes.raw()->host;
+                                                return measure([&]()
+                                                               {
+                                                                 nb_elements.push_back(buffer.raw()->dim[0].extent * buffer.raw()->dim[1].extent);
+                                                                 return values[0] == tiralib::get_size(size, "M") && values[1] == tiralib::get_size(size, "N") ? 0 : 1; }); });
+  auto report = read_report(report_path);
+
+  EXPECT_EQ(status, 0);
+  EXPECT_EQ(report["nb_problem_sizes"], "2");
+  EXPECT_EQ(report["size_1_problem_size"], "M=5,N=20");
+  EXPECT_EQ(report.count("size_0_error"), 0);
+  EXPECT_EQ(report.count("size_1_error"), 0);
+  EXPECT_EQ(parse_exec_times(report["size_0_exec_times"]).size(), 2);
+  EXPECT_EQ(parse_exec_times(report["size_1_exec_times"]).size(), 2);
+  EXPECT_EQ(nb_elements.front(), 30);
+  EXPECT_EQ(nb_elements.back(), 100);
+  EXPECT_THROW(tiralib::get_size(tiralib::get_problem_sizes()[0], "K"), std::invalid_argument);
+
+  unsetenv("TIRAMISU_REPORT_FILE");
+  unsetenv("TIRAMISU_NB_EXEC");
+  unsetenv("TIRAMISU_PROBLEM_SIZES");
+}
+
+TEST(ExecutionTest, MachinePeaks)
+{
+  setenv("TIRAMISU_REPORT_FILE", "/tmp/tiralib_test_peaks_report.txt", 1);
+
+  int status = tiralib::measure_machine_peaks();
+  auto report = read_report("/tmp/tiralib_test_peaks_report.txt");
+
+  EXPECT_EQ(status, 0);
+  EXPECT_GT(std::stod(report["peak_gflops"]), 0);
+  EXPECT_GT(std::stod(report["peak_bandwidth"]), 0);
+
+  // the peaks of the host are read from the cache instead of being measured again
+  char hostname[256] = "";
+  gethostname(hostname, sizeof(hostname) - 1);
+  setenv("TIRAMISU_DEPS_CACHE_DIR", "/tmp", 1);
+  std::ofstream("/tmp/tiralib_machine_peaks_" + std::string(hostname) + ".txt") << "peak_gflops 12.5\npeak_bandwidth 40\n";
+  MachinePeaks peaks = get_machine_peaks();
+
+  EXPECT_EQ(peaks.gflops, 12.5);
+  EXPECT_EQ(peaks.bandwidth, 40);
+
+  unsetenv("TIRAMISU_REPORT_FILE");
+  unsetenv("TIRAMISU_DEPS_CACHE_DIR");
+}
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+#include <tiramisu/tiramisu.h>
+#include <TiraLibCPP/search.h>
+
+#include <fstream>
+
+using namespace tiramisu;
+
+void build_blur(function_continuation continuation)
+{
+  tiramisu::init("function_blur_MINI");
+
+  var xi("xi", 0, 34), yi("yi", 0, 18), ci("ci", 0, 5);
+  var x("x", 1, 34 - 1), y("y", 1, 18 - 1), c("c", 1, 5 - 1);
+
+  input input_img("input_img", {ci, yi, xi}, p_float64);
+
+  computation comp_blur("comp_blur", {c, y, x}, (input_img(c, y + 1, x - 1) + input_img(c, y + 1, x) + input_img(c, y + 1, x + 1) + input_img(c, y, x - 1) + input_img(c, y, x) + input_img(c, y, x + 1) + input_img(c, y - 1, x - 1) + input_img(c, y - 1, x) + input_img(c, y - 1, x + 1)) * 0.111111);
+
+  buffer input_buf("input_buf", {5, 18, 34}, p_float64, a_input);
+  buffer output_buf("output_buf", {5, 18, 34}, p_float64, a_output);
+
+  input_img.store_in(&input_buf);
+  comp_blur.store_in(&output_buf);
+
+  continuation({&input_buf, &output_buf});
+}
+
+// rewards parallel outer loops without executing anything
+double count_parallel_loops_cost(std::string schedule_str, Result &result)
+{
+  result = {.name = "function_blur_MINI", .legality = true, .success = true};
+  double cost = 10;
+  if (schedule_str.find("P(L0") != std::string::npos)
+    cost -= 5;
+  if (schedule_str.find("U(") != std::string::npos)
+    cost -= 1;
+  return cost;
+}
+
+TEST(SearchTest, CandidateActions)
+{
+  std::vector<std::string> candidates;
+  build_blur([&](std::vector<buffer *> buffers)
+             {
+               prepare_schedules_for_legality_checks(true);
+               candidates = get_candidate_actions(global::get_implicit_function(), ActionMenu()); });
+
+  EXPECT_NE(std::find(candidates.begin(), candidates.end(), "P(L0,comps=['comp_blur'])"), candidates.end());
+  EXPECT_NE(std::find(candidates.begin(), candidates.end(), "I(L1,L2,comps=['comp_blur'])"), candidates.end());
+  EXPECT_NE(std::find(candidates.begin(), candidates.end(), "U(L2,4,comps=['comp_blur'])"), candidates.end());
+  // the loops of comp_blur are too small for 32x32 tiles
+  EXPECT_EQ(std::find(candidates.begin(), candidates.end(), "T2(L0,L1,32,32,comps=['comp_blur'])"), candidates.end());
+}
+
+TEST(SearchTest, BeamSearch)
+{
+  SearchConfig config;
+  config.max_depth = 2;
+  config.beam_size = 2;
+
+  auto results = search_schedules("function_blur_MINI", build_blur, config, count_parallel_loops_cost);
+
+  ASSERT_FALSE(results.empty());
+  EXPECT_EQ(results[0].cost, 4);
+  EXPECT_NE(results[0].schedule_str.find("P(L0,comps=['comp_blur'])"), std::string::npos);
+}
+
+TEST(SearchTest, ExecutionBudget)
+{
+  SearchConfig config;
+  config.max_depth = 3;
+  config.max_executions = 3;
+  int nb_executions = 0;
+
+  auto results = search_schedules("function_blur_MINI", build_blur, config, [&](std::string schedule_str, Result &result)
+                                  {
+                                    nb_executions++;
+                                    return count_parallel_loops_cost(schedule_str, result); });
+
+  EXPECT_EQ(nb_executions, 3);
+}
+
+TEST(SearchTest, MCTSIsReproducible)
+{
+  SearchConfig config;
+  config.method = "mcts";
+  config.max_depth = 2;
+  config.mcts_iterations = 10;
+  config.seed = 42;
+
+  auto first = search_schedules("function_blur_MINI", build_blur, config, count_parallel_loops_cost);
+  auto second = search_schedules("function_blur_MINI", build_blur, config, count_parallel_loops_cost);
+
+  ASSERT_EQ(first.size(), second.size());
+  for (size_t i = 0; i < first.size(); i++)
+    EXPECT_EQ(first[i].schedule_str, second[i].schedule_str);
+}
+
+TEST(SearchTest, LegalActionsMask)
+{
+  std::string prefix = "I(L1,L2,comps=['comp_blur'])";
+  auto mask = get_legal_actions_mask("function_blur_MINI", build_blur, prefix, ActionMenu());
+
+  ASSERT_EQ(mask.actions.size(), mask.legal.size());
+  ASSERT_FALSE(mask.actions.empty());
+  // the mask agrees with evaluating every prefix|action on its own
+  for (size_t i = 0; i < mask.actions.size(); i++)
+  {
+    auto result = builder_schedule_str_to_result("function_blur_MINI", build_blur, prefix + "|" + mask.actions[i], Operation::legality);
+    EXPECT_EQ(mask.legal[i], result.legality) << mask.actions[i];
+  }
+}
+
+TEST(SearchTest, LegalActionsMaskAfterTags)
+{
+  // the tags of the P, U and V candidates must not leak into the candidates evaluated after them
+  std::string prefix = "U(L2,2,comps=['comp_blur'])";
+  auto mask = get_legal_actions_mask("function_blur_MINI", build_blur, prefix, ActionMenu());
+
+  ASSERT_EQ(mask.actions.size(), mask.legal.size());
+  for (size_t i = 0; i < mask.actions.size(); i++)
+  {
+    auto result = builder_schedule_str_to_result("function_blur_MINI", build_blur, prefix + "|" + mask.actions[i], Operation::legality);
+    EXPECT_EQ(mask.legal[i], result.legality) << mask.actions[i];
+  }
+}
+
+TEST(SearchTest, ParameterGrid)
+{
+  auto grid = get_parameter_grid({{"ti", {16, 32}}, {"u", {2, 4, 8}}});
+
+  ASSERT_EQ(grid.size(), 6);
+  EXPECT_EQ(grid[1], (std::map<std::string, int>{{"ti", 16}, {"u", 4}}));
+  EXPECT_EQ(instantiate_schedule_template("T2(L0,L1,$ti,$ti,comps=['comp00'])|U(L2,$u,comps=['comp00'])", grid[5]),
+            "T2(L0,L1,32,32,comps=['comp00'])|U(L2,8,comps=['comp00'])");
+  EXPECT_THROW(instantiate_schedule_template("U(L2,$v,comps=['comp00'])", grid[0]), std::invalid_argument);
+}
+
+// stands in for the cost model: answers every program and schedule with the length of the schedule
+void use_fake_cost_model()
+{
+  std::string script_path = "/tmp/tiralib_test_model.py";
+  std::ofstream script(script_path);
+  script << "import sys\n"
+            "while True:\n"
+            "    program = sys.stdin.readline()\n"
+            "    schedule = sys.stdin.readline()\n"
+            "    if not schedule:\n"
+            "        break\n"
+            "    print(float(len(schedule)), flush=True)\n";
+  script.close();
+  setenv("TIRAMISU_MODEL_SCRIPT", script_path.c_str(), 1);
+}
+
+TEST(SearchTest, PredictionSupportedActions)
+{
+  use_fake_cost_model();
+  std::vector<std::string> schedules = {"P(L0,comps=['comp_blur'])", "U(L2,4,comps=['comp_blur'])", "V(L2,4,comps=['comp_blur'])",
+                                        "I(L1,L2,comps=['comp_blur'])", "T2(L1,L2,4,8,comps=['comp_blur'])",
+                                        "Shift(L2,2,comps=['comp_blur'])"};
+  for (auto &schedule_str : schedules)
+  {
+    auto result = builder_schedule_str_to_result("function_blur_MINI", build_blur, schedule_str, Operation::prediction);
+    EXPECT_TRUE(result.legality) << schedule_str;
+    EXPECT_GT(result.predicted_speedup, 0) << schedule_str;
+    EXPECT_EQ(result.additional_info.find("prediction_unsupported"), std::string::npos) << schedule_str;
+  }
+}
+
+TEST(SearchTest, PredictionUnsupportedAction)
+{
+  use_fake_cost_model();
+  auto result = builder_schedule_str_to_result("function_blur_MINI", build_blur, "P(L0,comps=['comp_blur'])|R(L2,comps=['comp_blur'])", Operation::prediction);
+
+  EXPECT_TRUE(result.legality);
+  EXPECT_EQ(result.predicted_speedup, 0);
+  EXPECT_NE(result.additional_info.find("prediction_unsupported:R"), std::string::npos);
+}
+
+TEST(SearchTest, PredictionBatch)
+{
+  use_fake_cost_model();
+  std::vector<std::string> schedules = {"P(L0,comps=['comp_blur'])", "R(L2,comps=['comp_blur'])", "T2(L1,L2,4,8,comps=['comp_blur'])|U(L4,4,comps=['comp_blur'])"};
+  auto results = builder_schedule_strs_to_predictions("function_blur_MINI", build_blur, schedules);
+
+  // the batch answers every schedule like predicting it on its own
+  ASSERT_EQ(results.size(), schedules.size());
+  for (size_t i = 0; i < schedules.size(); i++)
+  {
+    auto result = builder_schedule_str_to_result("function_blur_MINI", build_blur, schedules[i], Operation::prediction);
+    EXPECT_EQ(results[i].legality, result.legality) << schedules[i];
+    EXPECT_EQ(results[i].predicted_speedup, result.predicted_speedup) << schedules[i];
+    EXPECT_EQ(results[i].additional_info, result.additional_info) << schedules[i];
+  }
+  EXPECT_EQ(results[1].predicted_speedup, 0);
+  EXPECT_GT(results[2].predicted_speedup, 0);
+}
+
+TEST(SearchTest, PredictionLargeBatch)
+{
+  // more schedules than a chunk sent to the model at once, the answers stay in the order of the schedules
+  use_fake_cost_model();
+  std::vector<std::string> schedules;
+  for (int i = 0; i < 150; i++)
+    schedules.push_back(i % 2 == 0 ? "P(L0,comps=['comp_blur'])" : "T2(L1,L2,4,8,comps=['comp_blur'])|U(L4,4,comps=['comp_blur'])");
+  auto results = builder_schedule_strs_to_predictions("function_blur_MINI", build_blur, schedules);
+
+  ASSERT_EQ(results.size(), schedules.size());
+  EXPECT_NE(results[0].predicted_speedup, results[1].predicted_speedup);
+  for (size_t i = 2; i < results.size(); i++)
+    EXPECT_EQ(results[i].predicted_speedup, results[i % 2].predicted_speedup) << i;
+}
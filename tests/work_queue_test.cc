@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <TiraLibCPP/work_queue.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// creates a queue directory and a fake generated executable that echoes its arguments as a serialized result
+std::tuple<std::string, std::string> make_test_queue(std::string test_name)
+{
+  std::string root = std::filesystem::temp_directory_path().string() + "/tiralib_" + test_name + "_" + std::to_string(getpid());
+  std::filesystem::remove_all(root);
+  std::filesystem::create_directories(root + "/bin");
+
+  std::string executable = root + "/bin/function_fake";
+  std::ofstream script(executable);
+  script << "#!/bin/sh\n";
+  script << "echo \"{\\\"name\\\": \\\"function_fake\\\",\\\"legality\\\": 1,\\\"isl_ast\\\": \\\"\\\",\\\"exec_times\\\": \\\"$1\\\",\\\"success\\\": 1,\\\"additional_info\\\": \\\"\\\"}\"\n";
+  script.close();
+  std::filesystem::permissions(executable, std::filesystem::perms::owner_all);
+
+  return std::make_tuple(root + "/queue", root + "/bin");
+}
+
+std::vector<WorkItem> make_test_items(int nb_items)
+{
+  std::vector<WorkItem> items;
+  for (int i = 0; i < nb_items; i++)
+  {
+    WorkItem item;
+    item.function_name = "function_fake";
+    item.operation = "legality";
+    item.schedule_str = "U(L0," + std::to_string(i + 2) + ",comps=['comp00'])";
+    items.push_back(item);
+  }
+  return items;
+}
+
+TEST(WorkQueueTest, SeveralLocalWorkers)
+{
+  auto [queue_dir, executables_dir] = make_test_queue("several_workers");
+  EXPECT_EQ(submit_work_items(queue_dir, make_test_items(20)), 20);
+
+  std::vector<pid_t> workers;
+  for (int i = 0; i < 3; i++)
+  {
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+      WorkerConfig config;
+      config.worker_id = "worker" + std::to_string(i);
+      config.executables_dir = executables_dir;
+      run_worker(queue_dir, config);
+      _exit(0);
+    }
+    workers.push_back(pid);
+  }
+  for (auto pid : workers)
+    waitpid(pid, nullptr, 0);
+
+  EXPECT_TRUE(work_queue_is_done(queue_dir));
+  EXPECT_EQ(collect_work_results(queue_dir).size(), 20);
+
+  // resubmitting the same batch is a no-op once the results are committed
+  EXPECT_EQ(submit_work_items(queue_dir, make_test_items(20)), 0);
+}
+
+TEST(WorkQueueTest, IdempotentCommit)
+{
+  auto [queue_dir, executables_dir] = make_test_queue("idempotent_commit");
+  auto items = make_test_items(1);
+  submit_work_items(queue_dir, items);
+  std::string item_id = get_work_item_id(items[0].function_name, items[0].operation, items[0].schedule_str);
+
+  EXPECT_TRUE(commit_work_result(queue_dir, "worker0", item_id, "{\"first\": 1}"));
+  EXPECT_FALSE(commit_work_result(queue_dir, "worker1", item_id, "{\"second\": 1}"));
+
+  auto results = collect_work_results(queue_dir);
+  EXPECT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0], "{\"first\": 1}");
+}
+
+TEST(WorkQueueTest, ResumeAfterWorkerLoss)
+{
+  auto [queue_dir, executables_dir] = make_test_queue("worker_loss");
+  submit_work_items(queue_dir, make_test_items(2));
+
+  // a worker claims an item and dies without committing
+  WorkerConfig lost_worker;
+  lost_worker.worker_id = "lost";
+  WorkItem item;
+  EXPECT_TRUE(claim_work_item(queue_dir, lost_worker, item));
+  EXPECT_EQ(requeue_expired_work_items(queue_dir, 0), 1);
+
+  WorkerConfig config;
+  config.worker_id = "survivor";
+  config.executables_dir = executables_dir;
+  run_worker(queue_dir, config);
+
+  EXPECT_TRUE(work_queue_is_done(queue_dir));
+  EXPECT_EQ(collect_work_results(queue_dir).size(), 2);
+}
+
+TEST(WorkQueueTest, FreshClaimIsNotExpired)
+{
+  auto [queue_dir, executables_dir] = make_test_queue("fresh_claim");
+  auto items = make_test_items(1);
+  submit_work_items(queue_dir, items);
+  std::string item_id = get_work_item_id(items[0].function_name, items[0].operation, items[0].schedule_str);
+
+  // the item waited in the queue for longer than the lease before being claimed
+  std::filesystem::last_write_time(queue_dir + "/pending/" + item_id, std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+  WorkerConfig config;
+  config.worker_id = "worker0";
+  WorkItem item;
+  EXPECT_TRUE(claim_work_item(queue_dir, config, item));
+
+  EXPECT_EQ(requeue_expired_work_items(queue_dir, 60), 0);
+}
+
+TEST(WorkQueueTest, HungEvaluationTimesOut)
+{
+  auto [queue_dir, executables_dir] = make_test_queue("hung_evaluation");
+  std::string executable = executables_dir + "/function_hung";
+  std::ofstream script(executable);
+  script << "#!/bin/sh\nsleep 60\n";
+  script.close();
+  std::filesystem::permissions(executable, std::filesystem::perms::owner_all);
+
+  WorkItem item;
+  item.function_name = "function_hung";
+  item.operation = "legality";
+  item.schedule_str = "";
+  submit_work_items(queue_dir, {item});
+
+  WorkerConfig config;
+  config.worker_id = "worker0";
+  config.executables_dir = executables_dir;
+  config.evaluation_timeout_seconds = 1;
+  auto begin = std::chrono::steady_clock::now();
+  run_worker(queue_dir, config);
+
+  // the executable is killed and its claim is settled by a result instead of being kept alive by the heartbeat
+  EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::seconds(30));
+  EXPECT_TRUE(work_queue_is_done(queue_dir));
+  auto results = collect_work_results(queue_dir);
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_NE(results[0].find("evaluation_timeout"), std::string::npos);
+}